@@ -0,0 +1,42 @@
+# Shell script to count cliques with several PivotScale processes on one machine
+# Usage: bash ShardRun.sh <num_shards> <kernel> <kernel args...>
+#   e.g. bash ShardRun.sh 4 pivotscale -f dblp.sg -c 8
+# Each shard writes its partial result to shard-<i>-of-<n>.part (in the current
+# directory), and the partial results are combined by pivotscale-merge.
+# The same partial results can be produced on separate machines by running
+# the kernel with -S <i>/<n> -p <file> on each, and then merged the same way.
+
+if [ $# -lt 2 ]; then
+  echo "Error: Please pass the number of shards and the kernel to run"
+  echo "Usage: bash ShardRun.sh <num_shards> <kernel> <kernel args...>"
+  exit 1
+fi
+
+NUM_SHARDS=$1
+KERNEL=$2
+shift 2
+
+make ${KERNEL} pivotscale-merge
+
+# Split hardware threads evenly between shards unless already set
+if [ -z "${OMP_NUM_THREADS}" ]; then
+  export OMP_NUM_THREADS=$(( $(nproc) / NUM_SHARDS > 0 ? $(nproc) / NUM_SHARDS : 1 ))
+fi
+
+PARTS=""
+PIDS=""
+for (( i=0; i<NUM_SHARDS; i++ )); do
+  PART="shard-${i}-of-${NUM_SHARDS}.part"
+  PARTS="${PARTS} ${PART}"
+  ./${KERNEL} "$@" -S ${i}/${NUM_SHARDS} -p ${PART} > ${PART}.log &
+  PIDS="${PIDS} $!"
+done
+
+for PID in ${PIDS}; do
+  if ! wait ${PID}; then
+    echo "Error: a shard failed (see shard-*-of-${NUM_SHARDS}.part.log)"
+    exit 1
+  fi
+done
+
+./pivotscale-merge ${PARTS}
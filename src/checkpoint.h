@@ -0,0 +1,242 @@
+// Copyright (c) 2025, The Regents of the University of California (Regents)
+// See LICENSE for license details
+
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "graph.h"
+#include "platform_atomics.h"
+#include "root_cost.h"
+
+
+/*
+PivotScale
+File:   Checkpoint
+Author: Amogh Lonkar, Scott Beamer
+
+Persists progress of a long-running count so it can be resumed
+- Roots (DAG vertices) are grouped into fixed-size blocks, and a block is
+  only recorded as done once all of its roots have finished
+- Counts are kept per block, so a saved file holds exactly the sum of the
+  counts of its done blocks (consistent even while counting continues)
+- Save() writes to a temporary file and atomically renames it over the old
+- Load() restores done blocks (skipped by RootDone) and their summed counts
+- Single-k counting uses one count, sweeps use one count per clique size
+- Can be restricted to a shard (a contiguous range of blocks balanced by
+  estimated root cost), so the saved file holds a partial result that
+  pivotscale-merge can combine with the other shards
+*/
+
+
+struct CountFileHeader {
+  static const uint64_t kMagic = 0x3130545043535650;  // "PVSCPT01"
+  uint64_t magic = kMagic;
+  int64_t num_nodes;
+  int64_t num_edges;
+  int32_t k;
+  int32_t num_counts;
+  int32_t count_bytes;
+  int32_t block_size;
+  int64_t num_blocks;
+};
+
+
+template <typename CountT_>
+class RootCheckpoint {
+  static const NodeID kBlockSize = 256;
+
+  std::string filename_;
+  CountFileHeader header_;
+  // blocks finished by a previous run (read only while counting)
+  std::vector<uint8_t> resumed_done_;
+  std::vector<CountT_> resumed_counts_;
+  // range of blocks this process is responsible for (shard)
+  int64_t first_block_;
+  int64_t last_block_;
+  // blocks finished by this run
+  std::vector<NodeID> roots_left_;
+  std::vector<CountT_> block_counts_;
+  // time-based trigger for periodic saves
+  std::chrono::steady_clock::time_point start_time_;
+  int64_t interval_ms_;
+  int64_t next_save_ms_;
+
+  int64_t ElapsedMillis() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start_time_).count();
+  }
+
+  bool BlockFinished(int64_t b) const {
+    return resumed_done_[b] ||
+           (__atomic_load_n(&roots_left_[b], __ATOMIC_ACQUIRE) == 0);
+  }
+
+ public:
+  RootCheckpoint(const std::string &filename, const Graph &dag, NodeID k,
+                 NodeID num_counts, double interval_secs) :
+      filename_(filename), interval_ms_(interval_secs * 1000) {
+    header_.num_nodes = dag.num_nodes();
+    header_.num_edges = dag.num_edges();
+    header_.k = k;
+    header_.num_counts = num_counts;
+    header_.count_bytes = sizeof(CountT_);
+    header_.block_size = kBlockSize;
+    header_.num_blocks = (dag.num_nodes() + kBlockSize - 1) / kBlockSize;
+    first_block_ = 0;
+    last_block_ = header_.num_blocks;
+    resumed_done_.assign(header_.num_blocks, false);
+    resumed_counts_.assign(num_counts, 0);
+    roots_left_.resize(header_.num_blocks);
+    for (int64_t b=0; b < header_.num_blocks; b++) {
+      int64_t block_end = std::min((b+1) * kBlockSize, dag.num_nodes());
+      roots_left_[b] = block_end - b * kBlockSize;
+    }
+    block_counts_.assign(header_.num_blocks * num_counts, 0);
+    start_time_ = std::chrono::steady_clock::now();
+    next_save_ms_ = interval_ms_;
+  }
+
+  // Only count blocks in shard (of num_shards), balanced by root cost
+  void RestrictToShard(const Graph &dag, int shard, int num_shards) {
+    std::vector<int64_t> block_costs(header_.num_blocks, 0);
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (int64_t b=0; b < header_.num_blocks; b++) {
+      int64_t block_end = std::min((b+1) * kBlockSize, dag.num_nodes());
+      for (NodeID v = b * kBlockSize; v < block_end; v++)
+        block_costs[b] += EstimateRootCost(dag, v);
+    }
+    int64_t total_cost = 0;
+    for (int64_t cost : block_costs)
+      total_cost += cost;
+    // shard i takes the blocks that start in [i*total/n, (i+1)*total/n)
+    auto cost_boundary = [&](int i) {
+      return static_cast<int64_t>(static_cast<double>(total_cost) * i /
+                                  num_shards);
+    };
+    int64_t cost_so_far = 0;
+    first_block_ = last_block_ = header_.num_blocks;
+    for (int64_t b=0; b < header_.num_blocks; b++) {
+      if ((first_block_ == header_.num_blocks) &&
+          (cost_so_far >= cost_boundary(shard)))
+        first_block_ = b;
+      if ((shard + 1 < num_shards) && (cost_so_far >= cost_boundary(shard+1))) {
+        last_block_ = b;
+        break;
+      }
+      cost_so_far += block_costs[b];
+    }
+    first_block_ = std::min(first_block_, last_block_);
+  }
+
+  // Returns false if there is no checkpoint file to resume from
+  bool Load() {
+    std::ifstream file(filename_, std::ios::in | std::ios::binary);
+    if (!file)
+      return false;
+    CountFileHeader saved;
+    file.read(reinterpret_cast<char*>(&saved), sizeof(saved));
+    if (!file || (saved.magic != CountFileHeader::kMagic)) {
+      std::cout << filename_ << " is not a checkpoint file" << std::endl;
+      std::exit(-9);
+    }
+    if ((saved.num_nodes != header_.num_nodes) ||
+        (saved.num_edges != header_.num_edges) || (saved.k != header_.k) ||
+        (saved.num_counts != header_.num_counts) ||
+        (saved.count_bytes != header_.count_bytes) ||
+        (saved.block_size != header_.block_size)) {
+      std::cout << "Checkpoint " << filename_ << " was made for a different";
+      std::cout << " graph, clique size, or count width" << std::endl;
+      std::exit(-9);
+    }
+    file.read(reinterpret_cast<char*>(resumed_done_.data()),
+              header_.num_blocks);
+    file.read(reinterpret_cast<char*>(resumed_counts_.data()),
+              header_.num_counts * sizeof(CountT_));
+    if (!file) {
+      std::cout << "Checkpoint " << filename_ << " is truncated" << std::endl;
+      std::exit(-9);
+    }
+    return true;
+  }
+
+  void Save() {
+    std::vector<uint8_t> done(header_.num_blocks);
+    std::vector<CountT_> counts(resumed_counts_);
+    for (int64_t b=0; b < header_.num_blocks; b++) {
+      done[b] = (b >= first_block_) && (b < last_block_) && BlockFinished(b);
+      if (done[b] && !resumed_done_[b]) {
+        for (NodeID i=0; i < header_.num_counts; i++)
+          counts[i] += block_counts_[b * header_.num_counts + i];
+      }
+    }
+    std::string tmp_filename = filename_ + ".tmp";
+    std::fstream file(tmp_filename, std::ios::out | std::ios::binary);
+    if (!file) {
+      std::cout << "Couldn't write to file " << tmp_filename << std::endl;
+      std::exit(-5);
+    }
+    file.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    file.write(reinterpret_cast<char*>(done.data()), header_.num_blocks);
+    file.write(reinterpret_cast<char*>(counts.data()),
+               header_.num_counts * sizeof(CountT_));
+    file.close();
+    if (!file || std::rename(tmp_filename.c_str(), filename_.c_str()) != 0) {
+      std::cout << "Couldn't save checkpoint " << filename_ << std::endl;
+      std::exit(-5);
+    }
+  }
+
+  // Called by any thread, only one of them saves once interval has elapsed
+  void MaybeSave() {
+    int64_t due = next_save_ms_;
+    int64_t now = ElapsedMillis();
+    if ((now >= due) && compare_and_swap(next_save_ms_, due, now+interval_ms_))
+      Save();
+  }
+
+  // True if v's block was finished previously or is outside of the shard
+  bool RootDone(NodeID v) const {
+    int64_t b = v / kBlockSize;
+    return resumed_done_[b] || (b < first_block_) || (b >= last_block_);
+  }
+
+  void FinishRoot(NodeID v, const CountT_ *root_counts) {
+    int64_t b = v / kBlockSize;
+    CountT_ *counts = &block_counts_[b * header_.num_counts];
+    for (NodeID i=0; i < header_.num_counts; i++) {
+      #pragma omp atomic
+      counts[i] += root_counts[i];
+    }
+    fetch_and_add(roots_left_[b], -1);
+  }
+
+  const std::vector<CountT_>& ResumedCounts() const {
+    return resumed_counts_;
+  }
+
+  int64_t NumResumedBlocks() const {
+    int64_t num_done = 0;
+    for (uint8_t d : resumed_done_)
+      num_done += d;
+    return num_done;
+  }
+
+  int64_t NumBlocks() const {
+    return header_.num_blocks;
+  }
+
+  int64_t NumShardBlocks() const {
+    return last_block_ - first_block_;
+  }
+};
+
+#endif  // CHECKPOINT_H_
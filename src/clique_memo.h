@@ -0,0 +1,189 @@
+// Copyright (c) 2025, The Regents of the University of California (Regents)
+// See LICENSE for license details
+
+#ifndef CLIQUE_MEMO_H_
+#define CLIQUE_MEMO_H_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cinttypes>
+#include <cstdio>
+#include <vector>
+
+#include "benchmark.h"
+#include "comb_cache.h"
+#include "hash_table8.hpp"
+
+
+/*
+PivotScale
+File:   CliqueMemo
+Author: Amogh Lonkar, Scott Beamer
+
+Per-thread cache from the shape of a small active set (given as bitmasks) to
+its clique polynomial (number of cliques of each size)
+- Key is the number of vertices and the upper triangle of the adjacency
+  matrix after relabeling vertices by degree (then by the degree sum of
+  their neighbors), so many isomorphic active sets share an entry, and each
+  key still has only one polynomial
+- At most 8 vertices, so the key fits in 32 bits and each count in a byte
+- Stops adding entries once full (kMaxEntries), but keeps answering hits
+- Counts hits and misses, so callers can report whether it pays
+*/
+
+
+// Hits and misses summed over threads
+struct CliqueMemoStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+
+  double HitRate() const {
+    int64_t lookups = hits + misses;
+    return (lookups == 0) ? 0 : static_cast<double>(hits) / lookups;
+  }
+
+  void Print() const {
+    PrintStep("Memo Hits", hits);
+    PrintStep("Memo Misses", misses);
+    char rate[16];
+    snprintf(rate, sizeof(rate), "%.4lf", HitRate());
+    PrintLabel("Memo Hit Rate", rate);
+  }
+};
+
+
+class CliqueMemo {
+ public:
+  static const NodeID kMaxVerts = 8;
+  // skips smaller active sets, which are cheaper to recurse on than to key
+  static const NodeID kMinVerts = 4;
+  static const size_t kMaxEntries = size_t(1) << 20;
+  using Poly = std::array<uint8_t, kMaxVerts + 1>;
+
+ private:
+  NodeID max_verts_;
+  emhash8::HashMap<uint32_t, Poly> cache_;
+  // polynomial of last miss
+  Poly miss_poly_;
+  int64_t hits_ = 0;
+  int64_t misses_ = 0;
+
+  // Adds the cliques (in bit order) extending one of size to poly
+  static void AddCliques(const uint64_t *masks, uint64_t candidates,
+                         NodeID size, Poly &poly) {
+    poly[size]++;
+    for (uint64_t rest = candidates; rest != 0; rest &= rest - 1) {
+      NodeID v = std::countr_zero(rest);
+      uint64_t later = ~((uint64_t(2) << v) - 1);
+      AddCliques(masks, candidates & masks[v] & later, size+1, poly);
+    }
+  }
+
+  // Relabels the active bits (into relabeled, which holds n masks) and
+  // returns the key of the result
+  static uint32_t Canonicalize(const uint64_t *masks, uint64_t active,
+                               uint64_t *relabeled) {
+    NodeID ids[kMaxVerts];
+    NodeID degrees[kMaxVerts];
+    int64_t ranks[kMaxVerts];
+    NodeID n = 0;
+    for (uint64_t rest = active; rest != 0; rest &= rest - 1) {
+      ids[n] = std::countr_zero(rest);
+      degrees[n] = std::popcount(masks[ids[n]] & active);
+      n++;
+    }
+    NodeID order[kMaxVerts];
+    for (NodeID i=0; i < n; i++) {
+      NodeID neigh_degrees = 0;
+      for (NodeID j=0; j < n; j++) {
+        if ((masks[ids[i]] >> ids[j]) & 1)
+          neigh_degrees += degrees[j];
+      }
+      ranks[i] = int64_t(degrees[i]) * kMaxVerts * kMaxVerts + neigh_degrees;
+      order[i] = i;
+    }
+    std::stable_sort(order, order + n, [&ranks](NodeID a, NodeID b) {
+      return ranks[a] > ranks[b]; });
+    uint32_t key = n;
+    NodeID bit = 4;
+    for (NodeID i=0; i < n; i++) {
+      uint64_t mask = 0;
+      for (NodeID j=0; j < n; j++) {
+        uint64_t adjacent = (masks[ids[order[i]]] >> ids[order[j]]) & 1;
+        mask |= adjacent << j;
+        if (j > i)
+          key |= static_cast<uint32_t>(adjacent) << bit++;
+      }
+      relabeled[i] = mask;
+    }
+    return key;
+  }
+
+ public:
+  explicit CliqueMemo(NodeID max_verts) :
+      max_verts_(std::min(max_verts, kMaxVerts)) {}
+
+  bool Covers(NodeID num_active) const {
+    return (num_active >= kMinVerts) && (num_active <= max_verts_);
+  }
+
+  // Clique polynomial of active (which Covers)
+  const Poly& Lookup(const uint64_t *masks, uint64_t active) {
+    uint64_t relabeled[kMaxVerts];
+    uint32_t key = Canonicalize(masks, active, relabeled);
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+      hits_++;
+      return it->second;
+    }
+    misses_++;
+    miss_poly_.fill(0);
+    NodeID n = std::popcount(active);
+    AddCliques(relabeled, (uint64_t(1) << n) - 1, 0, miss_poly_);
+    if (cache_.size() < kMaxEntries)
+      cache_.emplace_unique(key, miss_poly_);
+    return miss_poly_;
+  }
+
+  // Number of ways to add j vertices from a clique of active and num_pivots
+  // pivots
+  template <typename CountT_>
+  CountT_ Count(const uint64_t *masks, uint64_t active,
+                const CombCache<CountT_> &n_choose_k, NodeID num_pivots,
+                NodeID j) {
+    const Poly &poly = Lookup(masks, active);
+    NodeID n = std::popcount(active);
+    CountT_ count = 0;
+    for (NodeID i=std::max(j - num_pivots, 0); i <= std::min(j, n); i++)
+      count += CountT_(poly[i]) * n_choose_k(num_pivots, j - i);
+    return count;
+  }
+
+  // Adds the cliques of each size (up to max_k) below a node with holds and
+  // pivots whose active set is active
+  template <typename CountT_>
+  void AddCounts(const uint64_t *masks, uint64_t active,
+                 const CombCache<CountT_> &n_choose_k, NodeID max_k,
+                 std::vector<CountT_> &counts, NodeID holds, NodeID pivots) {
+    const Poly &poly = Lookup(masks, active);
+    NodeID n = std::popcount(active);
+    for (NodeID i=0; i <= std::min(n, max_k - holds); i++) {
+      if (poly[i] == 0)
+        break;
+      NodeID max_p = std::min(pivots, max_k - holds - i);
+      for (NodeID p=0; p <= max_p; p++)
+        counts[holds + i + p] += CountT_(poly[i]) * n_choose_k(pivots, p);
+    }
+  }
+
+  // Adds this thread's hits and misses to stats
+  void AddStatsTo(CliqueMemoStats &stats) const {
+    #pragma omp atomic
+    stats.hits += hits_;
+    #pragma omp atomic
+    stats.misses += misses_;
+  }
+};
+
+#endif  // CLIQUE_MEMO_H_
@@ -0,0 +1,116 @@
+// Copyright (c) 2025, The Regents of the University of California (Regents)
+// See LICENSE for license details
+
+#ifndef CLIQUE_WRITER_H_
+#define CLIQUE_WRITER_H_
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif  // _OPENMP
+
+
+/*
+PivotScale
+File:   CliqueWriter
+Author: Amogh Lonkar, Scott Beamer
+
+Writes cliques (one writer per thread) to a file through a fixed-size
+buffer, so memory use is bounded no matter how many cliques there are
+- Binary output is the 32-bit vertex IDs of each clique back-to-back, and
+  text output is one clique per line
+*/
+
+
+class CliqueWriter {
+  static const size_t kBufferBytes = 1 << 20;
+  // a 32-bit ID as text is at most 11 characters, plus a separator
+  static const size_t kMaxTextBytesPerID = 12;
+
+  FILE *file_;
+  bool text_;
+  std::vector<char> buffer_;
+  size_t used_ = 0;
+  bool failed_ = false;
+
+ public:
+  // k is the (largest) clique size, to size the buffer
+  CliqueWriter(const std::string &filename, NodeID k, bool text) :
+      text_(text) {
+    file_ = fopen(filename.c_str(), "wb");
+    if (file_ == nullptr) {
+      std::cout << "Couldn't open file " << filename << std::endl;
+      std::exit(-6);
+    }
+    buffer_.resize(std::max<size_t>(kBufferBytes, k * kMaxTextBytesPerID));
+  }
+
+  ~CliqueWriter() {
+    Flush();
+    fclose(file_);
+  }
+
+  // Returns false if the output couldn't be written
+  bool Write(std::span<const NodeID> clique) {
+    size_t max_bytes = clique.size() * kMaxTextBytesPerID;
+    if (buffer_.size() - used_ < max_bytes) {
+      if (!Flush())
+        return false;
+      if (buffer_.size() < max_bytes)
+        buffer_.resize(max_bytes);
+    }
+    if (text_) {
+      for (NodeID v : clique) {
+        char *end = std::to_chars(&buffer_[used_], &buffer_.back(), v).ptr;
+        used_ = end - buffer_.data();
+        buffer_[used_++] = ' ';
+      }
+      buffer_[used_-1] = '\n';
+    } else {
+      std::memcpy(&buffer_[used_], clique.data(), clique.size_bytes());
+      used_ += clique.size_bytes();
+    }
+    return true;
+  }
+
+  bool Flush() {
+    if ((used_ > 0) && (fwrite(buffer_.data(), 1, used_, file_) != used_))
+      failed_ = true;
+    used_ = 0;
+    return !failed_;
+  }
+
+  bool failed() const {
+    return failed_;
+  }
+};
+
+
+int ThreadNum() {
+  #ifdef _OPENMP
+    return omp_get_thread_num();
+  #else
+    return 0;
+  #endif  // _OPENMP
+}
+
+
+int MaxThreads() {
+  #ifdef _OPENMP
+    return omp_get_max_threads();
+  #else
+    return 1;
+  #endif  // _OPENMP
+}
+
+#endif  // CLIQUE_WRITER_H_
@@ -39,8 +39,10 @@ class CombCache {
  public:
   CombCache() {
     for (int n=0; n < kNumPrecompute; n++) {
-      for (int k=0; k <= n; k++) {
-        if (k == 0 || k == n)
+      for (int k=0; k < kNumPrecompute; k++) {
+        if (k > n)
+          memo[n][k] = 0;
+        else if (k == 0 || k == n)
           memo[n][k] = 1;
         else
           memo[n][k] = memo[n-1][k-1] + memo[n-1][k];
@@ -176,25 +176,388 @@ class CLKClique : public CLBase {
   int num_threads_;
   bool max_k_;
   double epsilon_;
+  std::string checkpoint_file_ = "";
+  double checkpoint_interval_ = 600;
+  bool resume_ = false;
+  double progress_interval_ = -1;
+  int shard_ = 0;
+  int num_shards_ = 1;
+  int color_min_active_ = 0;
+  bool peel_ = false;
+  double split_factor_ = 0;
+  double complement_density_ = 0;
+  int memo_max_verts_ = 0;
+  bool merge_twins_ = false;
+  int hub_min_degree_ = 0;
+  double hub_max_mib_ = 1024;
+  bool flat_rows_ = false;
+  std::string pivot_policy_ = "max";
+  // sweeps count all sizes at once, so lack options that depend on one k
+  bool sweep_;
 
  public:
-  CLKClique(int argc, char** argv, std::string name, int clique_size, bool max_k) :
-    CLBase(argc, argv, name), clique_size_(clique_size), max_k_(max_k)  {
-    get_args_ += "c:m";
+  CLKClique(int argc, char** argv, std::string name, int clique_size, bool max_k,
+            bool sweep = false) :
+    CLBase(argc, argv, name), clique_size_(clique_size), max_k_(max_k),
+    sweep_(sweep) {
+    get_args_ += "c:mp:i:rP:S:C:TE:D:M:WH:B:LV:";
     AddHelpLine('c', "k", "clique size", std::to_string(clique_size_));
     AddHelpLine('m', "", "count all possible sizes of cliques", "false");
+    AddHelpLine('p', "file", "periodically save progress to checkpoint file");
+    AddHelpLine('i', "secs", "seconds between checkpoint saves",
+                std::to_string(static_cast<int>(checkpoint_interval_)));
+    AddHelpLine('r', "", "resume from checkpoint file (skip done roots)",
+                "false");
+    AddHelpLine('P', "secs", "print progress every secs (0: on SIGUSR1 only)",
+                "off");
+    AddHelpLine('S', "i/n", "only count shard i of n (saves partial to -p)",
+                "0/1");
+    if (!sweep_) {
+      AddHelpLine('C', "n",
+                  "prune by coloring subgraphs with at least n vertices",
+                  "off");
+    }
+    if (!sweep_) {
+      AddHelpLine('T', "", "peel to k-core and k-truss before counting",
+                  "false");
+    }
+    AddHelpLine('E', "x", "split roots costing x times mean into edge tasks",
+                "off");
+    AddHelpLine('D', "d", "count roots with density at least d in complement",
+                "off");
+    AddHelpLine('M', "n", "memoize cliques of subgraphs with at most n (<= 8)",
+                "off");
+    AddHelpLine('W', "", "count one root per group with same out-neighbors",
+                "false");
+    AddHelpLine('H', "d", "split roots with out-degree at least d (hubs)",
+                "off");
+    AddHelpLine('B', "MiB", "memory cap for subgraphs shared by split roots",
+                std::to_string(static_cast<int>(hub_max_mib_)));
+    AddHelpLine('L', "", "build subgraph rows flat (one scan, no copies)",
+                "false");
+    AddHelpLine('V', "rule", "pivot by max, sample, prev, min (all: compare)",
+                pivot_policy_);
   }
 
   void HandleArg(signed char opt, char* opt_arg) override {
     switch (opt) {
       case 'c': clique_size_ = atoi(opt_arg);            break;
       case 'm': max_k_ = true;                           break;
+      case 'p': checkpoint_file_ = std::string(opt_arg); break;
+      case 'i': checkpoint_interval_ = atof(opt_arg);    break;
+      case 'r': resume_ = true;                          break;
+      case 'P': progress_interval_ = atof(opt_arg);      break;
+      case 'S': sscanf(opt_arg, "%d/%d", &shard_, &num_shards_); break;
+      case 'C': color_min_active_ = atoi(opt_arg);       break;
+      case 'T': peel_ = true;                            break;
+      case 'E': split_factor_ = atof(opt_arg);           break;
+      case 'D': complement_density_ = atof(opt_arg);     break;
+      case 'M': memo_max_verts_ = atoi(opt_arg);         break;
+      case 'W': merge_twins_ = true;                     break;
+      case 'H': hub_min_degree_ = atoi(opt_arg);         break;
+      case 'B': hub_max_mib_ = atof(opt_arg);            break;
+      case 'L': flat_rows_ = true;                       break;
+      case 'V': pivot_policy_ = std::string(opt_arg);    break;
       default: CLBase::HandleArg(opt, opt_arg);
     }
   }
 
+  bool ParseArgs() {
+    if (!CLBase::ParseArgs())
+      return false;
+    if (resume_ && (checkpoint_file_ == "")) {
+      std::cout << "Resuming requires a checkpoint file (-p)" << std::endl;
+      return false;
+    }
+    if ((num_shards_ < 1) || (shard_ < 0) || (shard_ >= num_shards_)) {
+      std::cout << "Invalid shard " << shard_ << "/" << num_shards_;
+      std::cout << " (Use -h for help)" << std::endl;
+      return false;
+    }
+    if ((num_shards_ > 1) && (checkpoint_file_ == "")) {
+      std::cout << "Sharding requires a partial result file (-p)" << std::endl;
+      return false;
+    }
+    if (sweep_ && (color_min_active_ != 0)) {
+      std::cout << "Coloring bounds (-C) need a single clique size, so";
+      std::cout << " can't be used with a sweep" << std::endl;
+      return false;
+    }
+    if (sweep_ && peel_) {
+      std::cout << "Peeling (-T) drops cliques smaller than k, so";
+      std::cout << " can't be used with a sweep" << std::endl;
+      return false;
+    }
+    const std::vector<std::string> policies = {"max", "sample", "prev", "min",
+                                               "all"};
+    if (std::find(policies.begin(), policies.end(), pivot_policy_) ==
+        policies.end()) {
+      std::cout << "Invalid pivot policy " << pivot_policy_;
+      std::cout << " (Use -h for help)" << std::endl;
+      return false;
+    }
+    if (compare_pivot_policies() &&
+        ((checkpoint_file_ != "") || (progress_interval_ >= 0))) {
+      std::cout << "Comparing pivot policies (-V all) can't checkpoint or";
+      std::cout << " report progress" << std::endl;
+      return false;
+    }
+    return true;
+  }
+
   int clique_size() const { return clique_size_; }
   bool max_k() const { return max_k_; }
+  std::string checkpoint_file() const { return checkpoint_file_; }
+  double checkpoint_interval() const { return checkpoint_interval_; }
+  bool resume() const { return resume_; }
+  double progress_interval() const { return progress_interval_; }
+  int shard() const { return shard_; }
+  int num_shards() const { return num_shards_; }
+  int color_min_active() const { return std::max(color_min_active_, 0); }
+  bool peel() const { return peel_; }
+  double split_factor() const { return std::max(split_factor_, 0.0); }
+  double complement_density() const {
+    return std::clamp(complement_density_, 0.0, 1.0);
+  }
+  int memo_max_verts() const { return std::clamp(memo_max_verts_, 0, 8); }
+  bool merge_twins() const { return merge_twins_; }
+  int hub_min_degree() const { return std::max(hub_min_degree_, 0); }
+  int64_t hub_max_bytes() const {
+    return static_cast<int64_t>(std::max(hub_max_mib_, 0.0) * (1 << 20));
+  }
+  bool flat_rows() const { return flat_rows_; }
+  std::string pivot_policy() const { return pivot_policy_; }
+  bool compare_pivot_policies() const { return pivot_policy_ == "all"; }
+};
+
+
+
+class CLServer : public CLBase {
+  std::string socket_path_ = "pivotscale.sock";
+  int num_workers_ = 1;
+  int idle_seconds_ = 30;
+
+ public:
+  CLServer(int argc, char** argv, std::string name) :
+    CLBase(argc, argv, name) {
+    get_args_ += "l:w:t:";
+    AddHelpLine('l', "path", "listen on unix domain socket at path",
+                socket_path_);
+    AddHelpLine('w', "n", "number of requests served concurrently",
+                std::to_string(num_workers_));
+    AddHelpLine('t', "s", "close connections idle for s seconds (0: never)",
+                std::to_string(idle_seconds_));
+  }
+
+  void HandleArg(signed char opt, char* opt_arg) override {
+    switch (opt) {
+      case 'l': socket_path_ = std::string(opt_arg);     break;
+      case 'w': num_workers_ = atoi(opt_arg);            break;
+      case 't': idle_seconds_ = atoi(opt_arg);           break;
+      default: CLBase::HandleArg(opt, opt_arg);
+    }
+  }
+
+  std::string socket_path() const { return socket_path_; }
+  int num_workers() const { return std::max(num_workers_, 1); }
+  int idle_seconds() const { return std::max(idle_seconds_, 0); }
+};
+
+
+
+class CLDynamic : public CLBase {
+  int clique_size_ = 3;
+  std::string updates_file_ = "";
+
+ public:
+  CLDynamic(int argc, char** argv, std::string name) :
+    CLBase(argc, argv, name) {
+    get_args_ += "c:e:";
+    AddHelpLine('c', "k", "largest clique size maintained",
+                std::to_string(clique_size_));
+    AddHelpLine('e', "file",
+                "edge updates (+ u v / - u v, blank line ends batch)");
+  }
+
+  void HandleArg(signed char opt, char* opt_arg) override {
+    switch (opt) {
+      case 'c': clique_size_ = atoi(opt_arg);            break;
+      case 'e': updates_file_ = std::string(opt_arg);    break;
+      default: CLBase::HandleArg(opt, opt_arg);
+    }
+  }
+
+  bool ParseArgs() {
+    if (!CLBase::ParseArgs())
+      return false;
+    if (clique_size_ < 2) {
+      std::cout << "Clique size must be at least 2" << std::endl;
+      return false;
+    }
+    if (updates_file_ == "") {
+      std::cout << "No edge updates given (Use -h for help)" << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  int clique_size() const { return clique_size_; }
+  std::string updates_file() const { return updates_file_; }
+};
+
+
+class CLList : public CLBase {
+  int clique_size_ = 3;
+  std::string output_prefix_ = "";
+  bool text_ = false;
+  int64_t max_cliques_ = 0;
+
+ public:
+  CLList(int argc, char** argv, std::string name) :
+    CLBase(argc, argv, name) {
+    get_args_ += "c:o:tL:";
+    AddHelpLine('c', "k", "clique size", std::to_string(clique_size_));
+    AddHelpLine('o', "prefix", "write cliques to prefix.<thread> files");
+    AddHelpLine('t', "", "write cliques as text instead of binary", "false");
+    AddHelpLine('L', "n", "stop after listing n cliques (0: no limit)",
+                std::to_string(max_cliques_));
+  }
+
+  void HandleArg(signed char opt, char* opt_arg) override {
+    switch (opt) {
+      case 'c': clique_size_ = atoi(opt_arg);            break;
+      case 'o': output_prefix_ = std::string(opt_arg);   break;
+      case 't': text_ = true;                            break;
+      case 'L': max_cliques_ = atol(opt_arg);            break;
+      default: CLBase::HandleArg(opt, opt_arg);
+    }
+  }
+
+  bool ParseArgs() {
+    if (!CLBase::ParseArgs())
+      return false;
+    if ((clique_size_ < 1) || (max_cliques_ < 0)) {
+      std::cout << "Invalid clique size or limit (Use -h for help)";
+      std::cout << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  int clique_size() const { return clique_size_; }
+  std::string output_prefix() const { return output_prefix_; }
+  bool text() const { return text_; }
+  int64_t max_cliques() const { return max_cliques_; }
+};
+
+
+class CLMaximal : public CLBase {
+  std::string output_prefix_ = "";
+  bool text_ = false;
+
+ public:
+  CLMaximal(int argc, char** argv, std::string name) :
+    CLBase(argc, argv, name) {
+    get_args_ += "o:t";
+    AddHelpLine('o', "prefix", "write cliques to prefix.<thread> files");
+    AddHelpLine('t', "", "write cliques as text instead of binary", "false");
+  }
+
+  void HandleArg(signed char opt, char* opt_arg) override {
+    switch (opt) {
+      case 'o': output_prefix_ = std::string(opt_arg);   break;
+      case 't': text_ = true;                            break;
+      default: CLBase::HandleArg(opt, opt_arg);
+    }
+  }
+
+  std::string output_prefix() const { return output_prefix_; }
+  bool text() const { return text_; }
+};
+
+
+class CLSct : public CLBase {
+  std::string output_file_ = "";
+
+ public:
+  CLSct(int argc, char** argv, std::string name) :
+    CLBase(argc, argv, name) {
+    get_args_ += "o:";
+    AddHelpLine('o', "file", "write clique tree to file (required)");
+  }
+
+  void HandleArg(signed char opt, char* opt_arg) override {
+    switch (opt) {
+      case 'o': output_file_ = std::string(opt_arg);     break;
+      default: CLBase::HandleArg(opt, opt_arg);
+    }
+  }
+
+  bool ParseArgs() {
+    if (!CLBase::ParseArgs())
+      return false;
+    if (output_file_ == "") {
+      std::cout << "No output file given (Use -h for help)" << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  std::string output_file() const { return output_file_; }
+};
+
+
+// Queries a saved clique tree, so takes no graph input
+class CLQuery : public CLBase {
+  std::string sct_file_ = "";
+  int clique_size_ = 0;
+  std::string subset_file_ = "";
+  std::string vertex_counts_file_ = "";
+
+ public:
+  CLQuery(int argc, char** argv, std::string name) :
+    CLBase(argc, argv, name) {
+    get_args_ = "hi:c:s:v:";
+    help_strings_.clear();
+    AddHelpLine('h', "", "print this help message");
+    AddHelpLine('i', "file", "clique tree file (required)");
+    AddHelpLine('c', "k", "clique size (0: all sizes)", "0");
+    AddHelpLine('s', "file", "only count cliques within vertices in file");
+    AddHelpLine('v', "file", "write per-vertex counts (needs -c) to file");
+  }
+
+  void HandleArg(signed char opt, char* opt_arg) override {
+    switch (opt) {
+      case 'h': PrintUsage();                            break;
+      case 'i': sct_file_ = std::string(opt_arg);        break;
+      case 'c': clique_size_ = atoi(opt_arg);            break;
+      case 's': subset_file_ = std::string(opt_arg);     break;
+      case 'v': vertex_counts_file_ = std::string(opt_arg); break;
+    }
+  }
+
+  bool ParseArgs() {
+    signed char c_opt;
+    extern char *optarg;          // from and for getopt
+    while ((c_opt = getopt(argc_, argv_, get_args_.c_str())) != -1) {
+      HandleArg(c_opt, optarg);
+    }
+    if (sct_file_ == "") {
+      std::cout << "No clique tree given (Use -h for help)" << std::endl;
+      return false;
+    }
+    if ((clique_size_ < 0) ||
+        ((vertex_counts_file_ != "") && (clique_size_ == 0))) {
+      std::cout << "Invalid clique size (Use -h for help)" << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  std::string sct_file() const { return sct_file_; }
+  int clique_size() const { return clique_size_; }
+  std::string subset_file() const { return subset_file_; }
+  std::string vertex_counts_file() const { return vertex_counts_file_; }
 };
 
 #endif  // COMMAND_LINE_H_
@@ -119,7 +119,7 @@ class CSRGraph {
   void ReleaseResources() {
     if (out_index_ != nullptr)
       delete[] out_index_;
-    if (out_neighbors_ != nullptr)
+    if ((out_neighbors_ != nullptr) && owns_neighbors_)
       delete[] out_neighbors_;
     if (directed_) {
       if (in_index_ != nullptr)
@@ -153,7 +153,8 @@ class CSRGraph {
   CSRGraph(CSRGraph&& other) : directed_(other.directed_),
     num_nodes_(other.num_nodes_), num_edges_(other.num_edges_),
     out_index_(other.out_index_), out_neighbors_(other.out_neighbors_),
-    in_index_(other.in_index_), in_neighbors_(other.in_neighbors_) {
+    in_index_(other.in_index_), in_neighbors_(other.in_neighbors_),
+    owns_neighbors_(other.owns_neighbors_) {
       other.num_edges_ = -1;
       other.num_nodes_ = -1;
       other.out_index_ = nullptr;
@@ -166,6 +167,14 @@ class CSRGraph {
     ReleaseResources();
   }
 
+  // Undirected graph with neighbors owned by the caller (not freed by graph)
+  static CSRGraph FromExternal(int64_t num_nodes, DestID_** index,
+                               DestID_* neighs) {
+    CSRGraph g(num_nodes, index, neighs);
+    g.owns_neighbors_ = false;
+    return g;
+  }
+
   CSRGraph& operator=(CSRGraph&& other) {
     if (this != &other) {
       ReleaseResources();
@@ -176,6 +185,7 @@ class CSRGraph {
       out_neighbors_ = other.out_neighbors_;
       in_index_ = other.in_index_;
       in_neighbors_ = other.in_neighbors_;
+      owns_neighbors_ = other.owns_neighbors_;
       other.num_edges_ = -1;
       other.num_nodes_ = -1;
       other.out_index_ = nullptr;
@@ -270,6 +280,7 @@ class CSRGraph {
   DestID_*  out_neighbors_;
   DestID_** in_index_;
   DestID_*  in_neighbors_;
+  bool owns_neighbors_ = true;
 };
 
 #endif  // GRAPH_H_
@@ -4,6 +4,7 @@
 #ifndef GROUPED_STACK_H_
 #define GROUPED_STACK_H_
 
+#include <cstddef>
 #include <span>
 #include <vector>
 
@@ -20,7 +21,8 @@ with pop_frame().
 
 NOTE: For stability of the output of last_frame_iter, ensure no insertions
 (via push_back) or you have used reserve(new_size) to prevent the need for
-realloc.
+realloc. Otherwise, use last_frame, which reads the frame by index, so it
+stays valid while later frames are pushed (until its own frame is popped).
 */
 
 
@@ -30,6 +32,37 @@ class GroupedStack {
   std::vector<size_t> starts_;
 
  public:
+  // Frame read by index into the stack (rather than by pointer), and can be
+  // converted to a span for use before anything else is pushed
+  class Frame {
+    const std::vector<T_> *elems_;
+    size_t start_;
+    size_t end_;
+
+   public:
+    class Iter {
+      const std::vector<T_> *elems_;
+      size_t i_;
+
+     public:
+      Iter(const std::vector<T_> *elems, size_t i) : elems_(elems), i_(i) {}
+      T_ operator*() const { return (*elems_)[i_]; }
+      Iter& operator++() { i_++; return *this; }
+      bool operator!=(const Iter &other) const { return i_ != other.i_; }
+    };
+
+    Frame(const std::vector<T_> *elems, size_t start, size_t end) :
+        elems_(elems), start_(start), end_(end) {}
+
+    Iter begin() const { return Iter(elems_, start_); }
+    Iter end() const { return Iter(elems_, end_); }
+    size_t size() const { return end_ - start_; }
+
+    operator std::span<const T_>() const {
+      return std::span<const T_>(elems_->data() + start_, end_ - start_);
+    }
+  };
+
   GroupedStack() {}
 
   void reserve(int num_elems) {
@@ -45,16 +78,28 @@ class GroupedStack {
     elems_.push_back(new_elem);
   }
 
+  void append(std::span<const T_> new_elems) {
+    elems_.insert(elems_.end(), new_elems.begin(), new_elems.end());
+  }
+
   std::span<const T_> last_frame_iter() const {
     return std::span(elems_.begin() + starts_.back(), elems_.end());
   }
 
+  Frame last_frame() const {
+    return Frame(&elems_, starts_.back(), elems_.size());
+  }
+
   void pop_frame() {
     size_t new_size = starts_.back();
     starts_.pop_back();
     elems_.resize(new_size);
   }
 
+  bool empty() const {
+    return starts_.empty();
+  }
+
   void clear() {
     // assert(starts_.size() == 0);
     // assert(elems_.size() == 0);
@@ -0,0 +1,258 @@
+// Copyright (c) 2025, The Regents of the University of California (Regents)
+// See LICENSE for license details
+
+#include "libpivotscale.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "pivot_count.h"
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif  // _OPENMP
+
+
+/*
+PivotScale
+File:   libpivotscale
+Author: Amogh Lonkar, Scott Beamer
+
+Implementation of the embeddable API (see libpivotscale.h)
+- Wraps the caller's arrays in a Graph that only owns its index
+- Directionalizes like Ordering::Directionalize, but without printing
+- Dispatches to the counting kernels instantiated for 64 or 128-bit counts
+- Passes the requested number of threads to each parallel region of
+  validation and counting, but ordering (in the constructor) goes through
+  shared helpers without a per-call thread count, so it sets the calling
+  thread's OpenMP thread count for its duration instead
+*/
+
+
+namespace pivotscale {
+
+namespace {
+
+// Uses the requested number of OpenMP threads (for parallel regions started
+// by the calling thread) until it goes out of scope
+class ThreadScope {
+  int prior_threads_ = 0;
+
+ public:
+  explicit ThreadScope(int num_threads) {
+    #ifdef _OPENMP
+      if (num_threads > 0) {
+        prior_threads_ = omp_get_max_threads();
+        omp_set_num_threads(num_threads);
+      }
+    #endif  // _OPENMP
+  }
+
+  ~ThreadScope() {
+    #ifdef _OPENMP
+      if (prior_threads_ > 0)
+        omp_set_num_threads(prior_threads_);
+    #endif  // _OPENMP
+  }
+};
+
+
+template <typename CountT_>
+std::vector<unsigned __int128> Widen(const std::vector<CountT_> &counts) {
+  return std::vector<unsigned __int128>(counts.begin(), counts.end());
+}
+
+}  // namespace
+
+
+struct CliqueCounter::Impl {
+  enum class Kind { kCount, kSweep, kPerVertex };
+
+  Options opts;
+  std::string error;
+  Graph dag;
+  NodeID max_degree = 0;
+  double ordering_seconds = 0;
+
+  int NumThreads() const {
+    #ifdef _OPENMP
+      return (opts.num_threads > 0) ? opts.num_threads : omp_get_max_threads();
+    #else
+      return 1;
+    #endif  // _OPENMP
+  }
+
+  std::string ValidateCSR(int64_t num_nodes, const int64_t *offsets,
+                          const int32_t *neighbors) const {
+    if ((num_nodes < 0) || (num_nodes >= INT32_MAX))
+      return "number of nodes must be in [0, 2^31-1)";
+    if ((offsets == nullptr) || ((neighbors == nullptr) && (num_nodes > 0) &&
+                                 (offsets[num_nodes] > offsets[0])))
+      return "offsets and neighbors must be given";
+    int64_t bad_offsets = 0, bad_neighbors = 0;
+    #pragma omp parallel for reduction(+ : bad_offsets, bad_neighbors) \
+      num_threads(NumThreads())
+    for (NodeID u=0; u < num_nodes; u++) {
+      if (offsets[u] > offsets[u+1]) {
+        bad_offsets++;
+        continue;
+      }
+      for (int64_t e = offsets[u]; e < offsets[u+1]; e++) {
+        if ((neighbors[e] < 0) || (neighbors[e] >= num_nodes) ||
+            (neighbors[e] == u))
+          bad_neighbors++;
+      }
+    }
+    if (bad_offsets != 0)
+      return "offsets must be non-decreasing";
+    if (bad_neighbors != 0)
+      return "neighbors must be vertex IDs other than their source";
+    return "";
+  }
+
+  void Directionalize(Graph &g) {
+    bool use_core = false;
+    if (opts.ordering == OrderingType::kCore)
+      use_core = true;
+    else if (opts.ordering == OrderingType::kAuto)
+      use_core = (g.num_edges() > 0) && Ordering::CoreIsAdvantageous(g);
+    if (use_core) {
+      double epsilon = -0.5;
+      std::vector<NodeID> ranking = Ordering::CoreApprox(g, epsilon);
+      dag = Builder::DirectGraphCore(g, ranking);
+    } else {
+      dag = Builder::DirectGraphDegree(g);
+    }
+  }
+
+  template <typename CountT_>
+  std::vector<unsigned __int128> Run(Kind kind, NodeID k) const {
+    PivotCountOptions<CountT_> count_opts;
+    count_opts.merge_twins = opts.merge_twins;
+    count_opts.num_threads = opts.num_threads;
+    switch (kind) {
+      case Kind::kCount: {
+        std::vector<CountT_> counts(k+1, 0);
+        counts[k] = PivotCount(dag, k, count_opts);
+        return Widen(counts);
+      }
+      case Kind::kSweep:
+        return Widen(PivotCountSweep(dag, k, count_opts));
+      case Kind::kPerVertex:
+        return Widen(PivotCountPerVertex(dag, k, count_opts));
+    }
+    return {};
+  }
+
+  Result Count(Kind kind, int k) const {
+    Result result;
+    result.ordering_seconds = ordering_seconds;
+    if (!error.empty()) {
+      result.error = error;
+      return result;
+    }
+    if (k < 0 || ((k == 0) && (kind != Kind::kSweep))) {
+      result.error = "clique size must be positive";
+      return result;
+    }
+    if (kind == Kind::kSweep) {
+      // no clique can have more vertices than max out-degree + 1
+      k = (k == 0) ? max_degree + 1 : std::min(k, max_degree + 1);
+    }
+    Timer t;
+    t.Start();
+    if (opts.count_width == CountWidth::k128)
+      result.counts = Run<unsigned __int128>(kind, k);
+    else
+      result.counts = Run<uint64_t>(kind, k);
+    t.Stop();
+    result.counting_seconds = t.Seconds();
+    return result;
+  }
+
+  Result List(int k, const CliqueCallback &callback,
+              int64_t max_cliques) const {
+    Result result;
+    result.ordering_seconds = ordering_seconds;
+    if (!error.empty()) {
+      result.error = error;
+      return result;
+    }
+    if ((k <= 0) || (max_cliques < 0) || !callback) {
+      result.error = "clique size must be positive and a callback given";
+      return result;
+    }
+    Timer t;
+    t.Start();
+    PivotCountOptions<uint64_t> count_opts;
+    count_opts.num_threads = opts.num_threads;
+    int64_t num_listed = PivotList(dag, k, max_cliques, count_opts,
+      [&callback, k](std::span<const NodeID> clique) {
+        return callback(clique.data(), k); });
+    t.Stop();
+    result.counts.assign(k+1, 0);
+    result.counts[k] = num_listed;
+    result.counting_seconds = t.Seconds();
+    return result;
+  }
+};
+
+
+CliqueCounter::CliqueCounter(int64_t num_nodes, const int64_t *offsets,
+                             const int32_t *neighbors, const Options &opts) :
+    impl_(std::make_unique<Impl>()) {
+  impl_->opts = opts;
+  impl_->error = impl_->ValidateCSR(num_nodes, offsets, neighbors);
+  if (!impl_->error.empty())
+    return;
+  // graph only owns index (pointers into caller's neighbors)
+  NodeID *neighs = const_cast<NodeID*>(neighbors);
+  NodeID **index = new NodeID*[num_nodes+1];
+  #pragma omp parallel for num_threads(impl_->NumThreads())
+  for (NodeID n=0; n < num_nodes+1; n++)
+    index[n] = neighs + offsets[n];
+  Graph g = Graph::FromExternal(num_nodes, index, neighs);
+  Timer t;
+  t.Start();
+  {
+    ThreadScope threads(opts.num_threads);
+    if (opts.ordering == OrderingType::kNone)
+      impl_->dag = std::move(g);
+    else
+      impl_->Directionalize(g);
+    t.Stop();
+    impl_->max_degree = Ordering::FindMaxDegree(impl_->dag);
+  }
+  impl_->ordering_seconds = t.Seconds();
+}
+
+
+CliqueCounter::~CliqueCounter() {}
+
+
+const std::string& CliqueCounter::error() const {
+  return impl_->error;
+}
+
+
+Result CliqueCounter::Count(int k) const {
+  return impl_->Count(Impl::Kind::kCount, k);
+}
+
+
+Result CliqueCounter::Sweep(int max_k) const {
+  return impl_->Count(Impl::Kind::kSweep, max_k);
+}
+
+
+Result CliqueCounter::PerVertex(int k) const {
+  return impl_->Count(Impl::Kind::kPerVertex, k);
+}
+
+
+Result CliqueCounter::List(int k, const CliqueCallback &callback,
+                           int64_t max_cliques) const {
+  return impl_->List(k, callback, max_cliques);
+}
+
+}  // namespace pivotscale
@@ -0,0 +1,98 @@
+// Copyright (c) 2025, The Regents of the University of California (Regents)
+// See LICENSE for license details
+
+#ifndef LIBPIVOTSCALE_H_
+#define LIBPIVOTSCALE_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/*
+PivotScale
+File:   libpivotscale
+Author: Amogh Lonkar, Scott Beamer
+
+Embeddable clique counting API (link with libpivotscale.a and OpenMP)
+- Counts cliques of a graph already in memory in CSR form: offsets has
+  num_nodes+1 entries and neighbors of vertex v are
+  neighbors[offsets[v]..offsets[v+1]), with both arrays owned by the caller
+- Input is undirected (both directions of every edge) with sorted neighbors
+  and no self-loops or duplicates, or with OrderingType::kNone is already a
+  DAG (each edge once, no cycles) that is counted without any copying
+- Never exits the process, problems are reported by error() (construction)
+  or Result::error (counting)
+- Not reentrant yet: tuning overrides (PIVOTSCALE_* environment variables)
+  are read once into shared statics, and constructing a counter sets the
+  calling thread's OpenMP thread count while ordering, so counters should
+  be built and used from one host thread at a time
+- PivotScale's headers define non-inline functions, so a program linking
+  this library can't also include those headers (one definition rule)
+- Counts are always returned as 128-bit values, but are computed with the
+  requested count width (64-bit is faster but can overflow)
+- Cliques can also be listed through a callback, in the caller's vertex IDs
+*/
+
+
+namespace pivotscale {
+
+enum class OrderingType { kAuto, kDegree, kCore, kNone };
+
+enum class CountWidth { k64, k128 };
+
+struct Options {
+  OrderingType ordering = OrderingType::kAuto;
+  CountWidth count_width = CountWidth::k64;
+  int num_threads = 0;  // 0 uses the OpenMP default
+  bool merge_twins = false;  // count one root per group of twin roots
+};
+
+struct Result {
+  std::string error;  // empty if successful
+  std::vector<unsigned __int128> counts;
+  double ordering_seconds = 0;
+  double counting_seconds = 0;
+
+  bool ok() const { return error.empty(); }
+};
+
+// Called concurrently from the counting threads with the vertices of each
+// clique (in no particular order), and returns false to stop listing
+using CliqueCallback = std::function<bool(const int32_t *clique, int k)>;
+
+class CliqueCounter {
+ public:
+  CliqueCounter(int64_t num_nodes, const int64_t *offsets,
+                const int32_t *neighbors, const Options &opts = Options());
+  ~CliqueCounter();
+  CliqueCounter(const CliqueCounter&) = delete;
+  CliqueCounter& operator=(const CliqueCounter&) = delete;
+
+  // empty if graph was accepted and ordered
+  const std::string& error() const;
+
+  // counts[k] is the number of k-cliques
+  Result Count(int k) const;
+
+  // counts[i] is the number of i-cliques for all i <= max_k (0: all sizes)
+  Result Sweep(int max_k = 0) const;
+
+  // counts[v] is the number of k-cliques containing vertex v
+  Result PerVertex(int k) const;
+
+  // passes each k-clique to callback (stopping after max_cliques if nonzero),
+  // and counts[k] is the number passed
+  Result List(int k, const CliqueCallback &callback,
+              int64_t max_cliques = 0) const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace pivotscale
+
+#endif  // LIBPIVOTSCALE_H_
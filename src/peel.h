@@ -0,0 +1,254 @@
+// Copyright (c) 2025, The Regents of the University of California (Regents)
+// See LICENSE for license details
+
+#ifndef PEEL_H_
+#define PEEL_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "benchmark.h"
+#include "builder.h"
+#include "graph.h"
+#include "platform_atomics.h"
+#include "pvector.h"
+
+
+/*
+PivotScale
+File:   Peel
+Author: Amogh Lonkar, Scott Beamer
+
+Shrinks an undirected graph to the part that can contain k-cliques
+- A vertex in a k-clique has degree >= k-1, so peels to the (k-1)-core
+- An edge in a k-clique is in >= k-2 triangles, so peels to the k-truss
+- Both peel in parallel rounds, where the vertices (or edges) that fall
+  below the threshold in a round are removed together in the next round
+- Surviving vertices are relabeled densely (preserves clique counts, but
+  not vertex IDs)
+*/
+
+namespace Peel {
+
+// Returns which vertices are in the min_degree-core
+std::vector<uint8_t> CoreMembership(const Graph &g, NodeID min_degree) {
+  std::vector<uint8_t> alive(g.num_nodes(), true);
+  pvector<NodeID> degrees(g.num_nodes());
+  std::vector<NodeID> frontier;
+  #pragma omp parallel
+  {
+    std::vector<NodeID> local_frontier;
+    #pragma omp for nowait
+    for (NodeID u=0; u < g.num_nodes(); u++) {
+      degrees[u] = g.out_degree(u);
+      if (degrees[u] < min_degree) {
+        alive[u] = false;
+        local_frontier.push_back(u);
+      }
+    }
+    #pragma omp critical
+    frontier.insert(frontier.end(), local_frontier.begin(),
+                    local_frontier.end());
+  }
+  std::vector<NodeID> next_frontier;
+  while (!frontier.empty()) {
+    #pragma omp parallel
+    {
+      std::vector<NodeID> local_frontier;
+      #pragma omp for schedule(dynamic, 64) nowait
+      for (size_t i=0; i < frontier.size(); i++) {
+        for (NodeID v : g.out_neigh(frontier[i])) {
+          // only the decrement that crosses the threshold removes v
+          if (alive[v] && (fetch_and_add(degrees[v], -1) == min_degree)) {
+            alive[v] = false;
+            local_frontier.push_back(v);
+          }
+        }
+      }
+      #pragma omp critical
+      next_frontier.insert(next_frontier.end(), local_frontier.begin(),
+                           local_frontier.end());
+    }
+    frontier.swap(next_frontier);
+    next_frontier.clear();
+  }
+  return alive;
+}
+
+
+// Returns which arcs (both directions) are in the k-truss (edges in at least
+// min_support triangles of other surviving edges)
+std::vector<uint8_t> TrussMembership(const Graph &g, NodeID min_support) {
+  // edge states (for the arc from lower endpoint)
+  const uint8_t kAlive = 0, kRemoving = 1, kRemoved = 2;
+  int64_t num_arcs = g.num_edges_directed();
+  pvector<NodeID> supports(num_arcs, 0);
+  pvector<NodeID> sources(num_arcs);
+  std::vector<uint8_t> states(num_arcs, kAlive);
+  std::vector<int64_t> frontier;
+  NodeID *base = g.out_neigh(0).begin();
+
+  // canonical[e] is the index of arc e's edge (its arc from lower endpoint)
+  pvector<int64_t> canonical(num_arcs);
+  #pragma omp parallel for schedule(dynamic, 1024)
+  for (NodeID u=0; u < g.num_nodes(); u++) {
+    for (NodeID *it = g.out_neigh(u).begin(); it < g.out_neigh(u).end();
+         it++) {
+      sources[it - base] = u;
+      if (u < *it) {
+        canonical[it - base] = it - base;
+      } else {
+        auto neighs = g.out_neigh(*it);
+        canonical[it - base] = std::lower_bound(neighs.begin(), neighs.end(),
+                                                u) - base;
+      }
+    }
+  }
+
+  // Calls f(e_uw, e_vw) with the edges to each common neighbor w of u and v
+  auto for_each_triangle = [&](NodeID u, NodeID v, auto f) {
+    auto u_neighs = g.out_neigh(u);
+    auto v_neighs = g.out_neigh(v);
+    NodeID *it_v = v_neighs.begin();
+    for (NodeID *it_u = u_neighs.begin(); it_u < u_neighs.end(); it_u++) {
+      while ((it_v < v_neighs.end()) && (*it_v < *it_u))
+        it_v++;
+      if (it_v == v_neighs.end())
+        break;
+      if (*it_v == *it_u)
+        f(canonical[it_u - base], canonical[it_v - base]);
+    }
+  };
+
+  #pragma omp parallel
+  {
+    std::vector<int64_t> local_frontier;
+    #pragma omp for schedule(dynamic, 64) nowait
+    for (NodeID u=0; u < g.num_nodes(); u++) {
+      for (NodeID *it = g.out_neigh(u).begin(); it < g.out_neigh(u).end();
+           it++) {
+        int64_t e = it - base;
+        if (*it < u)
+          continue;
+        for_each_triangle(u, *it, [&supports, e](int64_t, int64_t) {
+          supports[e]++; });
+        if (supports[e] < min_support) {
+          states[e] = kRemoving;
+          local_frontier.push_back(e);
+        }
+      }
+    }
+    #pragma omp critical
+    frontier.insert(frontier.end(), local_frontier.begin(),
+                    local_frontier.end());
+  }
+
+  std::vector<int64_t> next_frontier;
+  while (!frontier.empty()) {
+    #pragma omp parallel
+    {
+      std::vector<int64_t> local_frontier;
+      #pragma omp for schedule(dynamic, 64) nowait
+      for (size_t i=0; i < frontier.size(); i++) {
+        int64_t e = frontier[i];
+        auto lose_triangle = [&](int64_t e_other) {
+          if ((states[e_other] == kAlive) &&
+              (fetch_and_add(supports[e_other], -1) == min_support))
+            local_frontier.push_back(e_other);
+        };
+        for_each_triangle(sources[e], base[e],
+                          [&](int64_t e_uw, int64_t e_vw) {
+          // triangle is already gone, or handled by lowest removing edge
+          if ((states[e_uw] == kRemoved) || (states[e_vw] == kRemoved))
+            return;
+          if (((states[e_uw] == kRemoving) && (e_uw < e)) ||
+              ((states[e_vw] == kRemoving) && (e_vw < e)))
+            return;
+          lose_triangle(e_uw);
+          lose_triangle(e_vw);
+        });
+      }
+      #pragma omp critical
+      next_frontier.insert(next_frontier.end(), local_frontier.begin(),
+                           local_frontier.end());
+    }
+    #pragma omp parallel for
+    for (size_t i=0; i < frontier.size(); i++)
+      states[frontier[i]] = kRemoved;
+    #pragma omp parallel for
+    for (size_t i=0; i < next_frontier.size(); i++)
+      states[next_frontier[i]] = kRemoving;
+    frontier.swap(next_frontier);
+    next_frontier.clear();
+  }
+
+  // mirror each surviving edge's state to its reverse arc
+  std::vector<uint8_t> alive(num_arcs);
+  #pragma omp parallel for
+  for (int64_t e=0; e < num_arcs; e++)
+    alive[e] = (states[canonical[e]] == kAlive);
+  return alive;
+}
+
+
+// Induces graph on arcs for which keep(u, arc index) is true, dropping
+// vertices left without neighbors and relabeling the rest densely
+template <typename KeepF_>
+Graph InduceByArcs(const Graph &g, KeepF_ keep) {
+  NodeID *base = g.out_neigh(0).begin();
+  pvector<NodeID> degrees(g.num_nodes());
+  #pragma omp parallel for schedule(dynamic, 1024)
+  for (NodeID u=0; u < g.num_nodes(); u++) {
+    degrees[u] = 0;
+    for (NodeID *it = g.out_neigh(u).begin(); it < g.out_neigh(u).end(); it++)
+      degrees[u] += keep(u, it - base);
+  }
+  std::vector<NodeID> new_ids(g.num_nodes(), -1);
+  NodeID num_kept = 0;
+  for (NodeID u=0; u < g.num_nodes(); u++) {
+    if (degrees[u] > 0)
+      new_ids[u] = num_kept++;
+  }
+  pvector<NodeID> new_degrees(num_kept);
+  #pragma omp parallel for
+  for (NodeID u=0; u < g.num_nodes(); u++) {
+    if (new_ids[u] != -1)
+      new_degrees[new_ids[u]] = degrees[u];
+  }
+  pvector<SGOffset> offsets = Builder::ParallelPrefixSum(new_degrees);
+  NodeID *neighs = new NodeID[offsets[num_kept]];
+  NodeID **index = Graph::GenIndex(offsets, neighs);
+  #pragma omp parallel for schedule(dynamic, 1024)
+  for (NodeID u=0; u < g.num_nodes(); u++) {
+    if (new_ids[u] == -1)
+      continue;
+    NodeID *out = index[new_ids[u]];
+    for (NodeID *it = g.out_neigh(u).begin(); it < g.out_neigh(u).end();
+         it++) {
+      if (keep(u, it - base))
+        *(out++) = new_ids[*it];
+    }
+    // relabeling preserves order, so neighbors remain sorted
+  }
+  return Graph(num_kept, index, neighs);
+}
+
+
+// Returns the part of g that can contain cliques of size k (k >= 3)
+Graph ShrinkForCliques(const Graph &g, NodeID k) {
+  if (g.num_nodes() == 0)
+    return InduceByArcs(g, [](NodeID, int64_t) { return true; });
+  std::vector<uint8_t> in_core = CoreMembership(g, k-1);
+  NodeID *base = g.out_neigh(0).begin();
+  Graph core = InduceByArcs(g, [&](NodeID u, int64_t e) {
+    return in_core[u] && in_core[base[e]]; });
+  if (core.num_nodes() == 0)
+    return core;
+  std::vector<uint8_t> in_truss = TrussMembership(core, k-2);
+  return InduceByArcs(core, [&in_truss](NodeID, int64_t e) {
+    return in_truss[e]; });
+}
+
+}  // namespace Peel
+
+#endif  // PEEL_H_
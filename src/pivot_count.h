@@ -0,0 +1,1471 @@
+// Copyright (c) 2025, The Regents of the University of California (Regents)
+// See LICENSE for license details
+
+#ifndef PIVOT_COUNT_H_
+#define PIVOT_COUNT_H_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <vector>
+
+#include "clique_memo.h"
+#include "platform_atomics.h"
+#include "pivotscale.h"
+#include "twins.h"
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif  // _OPENMP
+
+
+/*
+PivotScale
+File:   PivotCount
+Author: Amogh Lonkar, Scott Beamer
+
+Pivoting-based clique counting kernels shared by the PivotScale executables
+- PivotCount counts cliques of size k
+- PivotCountSweep counts cliques of all sizes up to and including max_k
+- PivotCountPerVertex counts the cliques of size k each vertex belongs to
+- PivotList lists the cliques of size k by expanding each leaf of the pivot
+  tree (its holds with every choice of its pivots) in original vertex IDs
+- PivotLeaves visits every leaf of the complete pivot tree (e.g., to save it
+  and answer later queries for any k without recounting)
+- All launch one task per root (DAG vertex) and can optionally checkpoint,
+  report progress, or only count cliques within a subset of vertices
+- PivotCount and PivotCountSweep can instead split costly roots into one
+  task per out-edge (see EdgeTasks) to balance load across many threads
+- PivotCount and PivotCountSweep can also split hub roots (high out-degree),
+  whose tasks share one local DAG built in parallel (see EdgeTasks)
+- PivotCount and PivotCountSweep finish subtrees with at most 64 active
+  vertices with bitmask kernels (see PivotRecurseMask)
+- PivotCount and PivotCountSweep count edgeless, complete, or near-complete
+  active sets in closed form instead of recursing (see ActiveShape)
+- PivotCount and PivotCountSweep can instead count roots with very dense
+  subgraphs as independent sets of the complement (see ComplementCounter)
+- PivotCount and PivotCountSweep can look up the cliques of small active
+  sets by their shape in a per-thread cache (see CliqueMemo)
+- PivotCount, PivotCountSweep, and PivotCountPerVertex can count one root
+  per group of twins (same out-neighbors) and reuse it (see RootTwins)
+- PivotCount and PivotCountSweep can build subgraph rows flat in one scan
+  of the DAG (see SubGraph::SetFlatRows)
+- PivotCount and PivotCountSweep can pick pivots by other rules (see
+  PivotPolicy), and ComparePivotPolicies times each on the same input
+- Templated by count type, and each call uses its own (n choose k) cache
+*/
+
+
+template <typename CountT_>
+struct PivotCountOptions {
+  RootCheckpoint<CountT_> *ckpt = nullptr;
+  ProgressMonitor *progress = nullptr;
+  // if given (sorted), only count cliques made entirely of these vertices
+  const std::vector<NodeID> *subset = nullptr;
+  // if nonzero, PivotCount prunes with coloring bounds (see PivotRecurse)
+  // in subgraphs with at least this many active vertices
+  NodeID color_min_active = 0;
+  // if nonzero, roots with at least this estimated cost (see RootCost) are
+  // split into one task per out-edge
+  int64_t split_root_cost = 0;
+  // if nonzero, roots with at least this out-degree (hubs) are also split,
+  // and split roots share subgraphs of at most hub_max_bytes (see EdgeTasks)
+  NodeID hub_min_degree = 0;
+  int64_t hub_max_bytes = int64_t(1) << 30;
+  // if nonzero, PivotCount and PivotCountSweep count roots (or edge tasks)
+  // whose subgraph has at least this density in its complement (see
+  // ComplementCounter)
+  double complement_density = 0;
+  // if nonzero, PivotCount and PivotCountSweep look up active sets with at
+  // most this many vertices in a per-thread CliqueMemo (adding its hits and
+  // misses to memo_stats if given)
+  NodeID memo_max_verts = 0;
+  CliqueMemoStats *memo_stats = nullptr;
+  // if true, PivotCount, PivotCountSweep, and PivotCountPerVertex count one
+  // root of each group of twins (see RootTwins), and add the number of
+  // roots merged into others to twins_merged if given
+  bool merge_twins = false;
+  int64_t *twins_merged = nullptr;
+  // if true, PivotCount and PivotCountSweep build the rows of each subgraph
+  // flat (see SubGraph::SetFlatRows)
+  bool flat_rows = false;
+  // rule PivotCount and PivotCountSweep pick pivots by (see PivotPolicy), and
+  // if given, where they add the number of pivot tree nodes searched
+  PivotPolicy pivot_policy = PivotPolicy::kMaxDegree;
+  int64_t *tree_nodes = nullptr;
+  // OpenMP threads for each parallel region (0: the OpenMP default), passed
+  // to the regions so callers never change the default for the process
+  int num_threads = 0;
+
+  int NumThreads() const {
+    #ifdef _OPENMP
+      return (num_threads > 0) ? num_threads : omp_get_max_threads();
+    #else
+      return 1;
+    #endif  // _OPENMP
+  }
+
+  NodeID NumRoots(const Graph &dag) const {
+    return subset ? subset->size() : dag.num_nodes();
+  }
+
+  NodeID Root(NodeID i) const {
+    return subset ? (*subset)[i] : i;
+  }
+
+  bool RootDone(NodeID v) const {
+    return (ckpt != nullptr) && ckpt->RootDone(v);
+  }
+
+  template <typename SubGraphT_>
+  void Induce(SubGraphT_ &sg, const Graph &dag, NodeID v) const {
+    if (subset == nullptr) {
+      sg.InduceFromDAG(dag, v);
+    } else {
+      sg.InduceFromDAG(dag, v, [this](NodeID w) {
+        return std::binary_search(subset->begin(), subset->end(), w); });
+    }
+  }
+
+  bool Included(NodeID v) const {
+    return (subset == nullptr) ||
+           std::binary_search(subset->begin(), subset->end(), v);
+  }
+
+  // Induces on the common out-neighbors of u and v (edge (u, v) in dag)
+  template <typename SubGraphT_>
+  void InduceEdge(SubGraphT_ &sg, const Graph &dag, NodeID u,
+                  NodeID v) const {
+    auto u_neighs = dag.out_neigh(u);
+    sg.InduceFromDAG(dag, v, [this, &u_neighs](NodeID w) {
+      return std::binary_search(u_neighs.begin(), u_neighs.end(), w) &&
+             Included(w); });
+  }
+};
+
+
+// Roots (not already done) with estimated cost at least split_root_cost or
+// out-degree at least hub_min_degree are split into one task per out-edge
+// (u, v), and each task counts the cliques whose two lowest-ranked vertices
+// are u and v (from clique_size 2)
+// - A root's tasks add their counts into the root's counts, and whichever
+//   finishes last reports the root (to checkpoint and progress)
+// - width is the number of counts per root (e.g., max_k+1 for a sweep)
+// - Split roots (costliest first) get the DAG induced on their out-neighbors
+//   built in parallel and shared by their tasks, while all of these fit in
+//   hub_max_bytes, so each task only scans that local DAG (rather than the
+//   out-neighbors of every common neighbor in the whole DAG), and each is
+//   freed once its root finishes
+template <typename CountT_>
+class EdgeTasks {
+  std::vector<uint8_t> split_;
+  std::vector<NodeID> roots_;
+  std::vector<int64_t> root_costs_;
+  std::vector<NodeID> num_tasks_;
+  std::vector<NodeID> remaining_;
+  std::vector<CountT_> root_counts_;
+  std::vector<NodeID> task_roots_;
+  std::vector<NodeID> task_neighs_;
+  // first task of each root, and local DAG shared by its tasks (if built),
+  // with local IDs by position among the root's tasks
+  std::vector<int64_t> first_tasks_;
+  std::vector<std::unique_ptr<Graph>> shared_dags_;
+  size_t width_;
+
+  static int64_t SharedBytes(int64_t num_verts, int64_t num_edges) {
+    return num_edges * sizeof(NodeID) + (num_verts + 1) * sizeof(NodeID*);
+  }
+
+  // DAG induced on verts (sorted), or nullptr if it exceeds max_bytes
+  static std::unique_ptr<Graph> InduceShared(const Graph &dag,
+                                             std::span<const NodeID> verts,
+                                             int64_t max_bytes) {
+    NodeID num_verts = verts.size();
+    auto local_id = [&verts](NodeID w) {
+      auto it = std::lower_bound(verts.begin(), verts.end(), w);
+      return ((it != verts.end()) && (*it == w)) ? NodeID(it - verts.begin())
+                                                 : NodeID(-1);
+    };
+    pvector<NodeID> degrees(num_verts, 0);
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (NodeID i=0; i < num_verts; i++) {
+      for (NodeID w : dag.out_neigh(verts[i])) {
+        if (local_id(w) != -1)
+          degrees[i]++;
+      }
+    }
+    pvector<SGOffset> offsets = Builder::ParallelPrefixSum(degrees);
+    if (SharedBytes(num_verts, offsets[num_verts]) > max_bytes)
+      return nullptr;
+    NodeID *neighs = new NodeID[offsets[num_verts]];
+    NodeID **index = Graph::GenIndex(offsets, neighs);
+    // out-neighbors are sorted, so local IDs come out sorted
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (NodeID i=0; i < num_verts; i++) {
+      NodeID *out = index[i];
+      for (NodeID w : dag.out_neigh(verts[i])) {
+        NodeID w_l = local_id(w);
+        if (w_l != -1)
+          *out++ = w_l;
+      }
+    }
+    return std::make_unique<Graph>(num_verts, index, neighs);
+  }
+
+  void BuildSharedDAGs(const Graph &dag, int64_t max_bytes) {
+    shared_dags_.resize(roots_.size());
+    std::vector<NodeID> by_cost(roots_.size());
+    std::iota(by_cost.begin(), by_cost.end(), 0);
+    std::sort(by_cost.begin(), by_cost.end(), [this](NodeID a, NodeID b) {
+      return root_costs_[a] > root_costs_[b]; });
+    int64_t bytes_left = max_bytes;
+    for (NodeID r : by_cost) {
+      std::span<const NodeID> verts(&task_neighs_[first_tasks_[r]],
+                                    num_tasks_[r]);
+      shared_dags_[r] = InduceShared(dag, verts, bytes_left);
+      if (shared_dags_[r]) {
+        bytes_left -= SharedBytes(num_tasks_[r],
+                                  shared_dags_[r]->num_edges_directed());
+      }
+    }
+  }
+
+ public:
+  EdgeTasks(const Graph &dag, const PivotCountOptions<CountT_> &opts,
+            size_t width, bool enabled = true) :
+      split_(opts.NumRoots(dag), false), width_(width) {
+    if (!enabled ||
+        ((opts.split_root_cost == 0) && (opts.hub_min_degree == 0)))
+      return;
+    #pragma omp parallel for schedule(dynamic, 1024) \
+      num_threads(opts.NumThreads())
+    for (NodeID i=0; i < opts.NumRoots(dag); i++) {
+      NodeID u = opts.Root(i);
+      bool is_hub = (opts.hub_min_degree != 0) &&
+                    (dag.out_degree(u) >= opts.hub_min_degree);
+      bool is_costly = (opts.split_root_cost != 0) &&
+                       (EstimateRootCost(dag, u) >= opts.split_root_cost);
+      split_[i] = !opts.RootDone(u) && (dag.out_degree(u) > 0) &&
+                  (is_hub || is_costly);
+    }
+    for (NodeID i=0; i < opts.NumRoots(dag); i++) {
+      if (!split_[i])
+        continue;
+      NodeID u = opts.Root(i);
+      NodeID num_tasks = 0;
+      first_tasks_.push_back(task_roots_.size());
+      for (NodeID v : dag.out_neigh(u)) {
+        if (opts.Included(v)) {
+          task_roots_.push_back(roots_.size());
+          task_neighs_.push_back(v);
+          num_tasks++;
+        }
+      }
+      if (num_tasks == 0) {
+        // nothing to split, so leave it to its own root task
+        split_[i] = false;
+        first_tasks_.pop_back();
+        continue;
+      }
+      roots_.push_back(u);
+      root_costs_.push_back(EstimateRootCost(dag, u));
+      num_tasks_.push_back(num_tasks);
+    }
+    remaining_ = num_tasks_;
+    root_counts_.assign(roots_.size() * width_, 0);
+    BuildSharedDAGs(dag, opts.hub_max_bytes);
+  }
+
+  // Induces task t's subgraph from its root's shared DAG (if built), or
+  // otherwise from the common out-neighbors of its edge in dag
+  template <typename SubGraphT_>
+  void Induce(SubGraphT_ &sg, const Graph &dag,
+              const PivotCountOptions<CountT_> &opts, int64_t t) const {
+    NodeID r = task_roots_[t];
+    if (shared_dags_[r])
+      sg.InduceFromDAG(*shared_dags_[r], t - first_tasks_[r]);
+    else
+      opts.InduceEdge(sg, dag, roots_[r], task_neighs_[t]);
+  }
+
+  bool IsSplit(NodeID i) const {
+    return split_[i];
+  }
+
+  NodeID NumRoots() const {
+    return roots_.size();
+  }
+
+  int64_t NumTasks() const {
+    return task_roots_.size();
+  }
+
+  NodeID TaskRoot(int64_t t) const {
+    return task_roots_[t];
+  }
+
+  NodeID Root(NodeID r) const {
+    return roots_[r];
+  }
+
+  NodeID TaskNeigh(int64_t t) const {
+    return task_neighs_[t];
+  }
+
+  CountT_* RootCounts(NodeID r) {
+    return &root_counts_[r * width_];
+  }
+
+  // Share of root's cost for each task (to weight progress)
+  int64_t TaskCost(int64_t t) const {
+    NodeID r = task_roots_[t];
+    return root_costs_[r] / num_tasks_[r];
+  }
+
+  // Adds task's counts to its root's, and returns if root is now finished
+  bool FinishTask(int64_t t, const CountT_ *counts) {
+    CountT_ *root_counts = RootCounts(task_roots_[t]);
+    for (size_t k=0; k < width_; k++) {
+      #pragma omp atomic
+      root_counts[k] += counts[k];
+    }
+    NodeID r = task_roots_[t];
+    if (fetch_and_add(remaining_[r], -1) != 1)
+      return false;
+    shared_dags_[r].reset();
+    return true;
+  }
+};
+
+
+// Groups twin roots (see RootTwins) if enabled, leaving out roots already
+// done or split into edge tasks (if given), as they are handled apart
+template <typename CountT_>
+RootTwins FindRootTwins(const Graph &dag,
+                        const PivotCountOptions<CountT_> &opts,
+                        const EdgeTasks<CountT_> *edge_tasks = nullptr) {
+  if (!opts.merge_twins)
+    return RootTwins();
+  RootTwins twins(dag, opts.NumRoots(dag),
+      [&opts](NodeID i) { return opts.Root(i); },
+      [&opts, edge_tasks](NodeID i) {
+        return !opts.RootDone(opts.Root(i)) &&
+               ((edge_tasks == nullptr) || !edge_tasks->IsSplit(i)); },
+      opts.NumThreads());
+  if (opts.twins_merged != nullptr)
+    *opts.twins_merged += twins.NumMerged();
+  return twins;
+}
+
+
+// Active sets whose cliques have a closed form count
+// - Edgeless: its cliques are the empty set and each vertex
+// - Near clique: complement is a matching of num_missing edges (none if
+//   complete), so a clique can use the free vertices and at most one
+//   vertex of each missing edge
+struct ActiveShape {
+  enum Kind { kOther, kEdgeless, kNearClique };
+  Kind kind = kOther;
+  NodeID num_active = 0;
+  NodeID num_missing = 0;
+
+  // From active edges and minimum active degree (only needed if it could be
+  // a near clique, so given as a function)
+  template <typename MinDegreeF_>
+  static ActiveShape Classify(NodeID num_active, int64_t num_edges,
+                              MinDegreeF_ min_degree) {
+    int64_t num_missing = int64_t(num_active) * (num_active - 1) / 2 -
+                          num_edges;
+    if (num_edges == 0)
+      return ActiveShape{kEdgeless, num_active, 0};
+    // a matching has at most num_active/2 edges, and leaves degree >= n-2
+    if ((num_missing == 0) || ((2 * num_missing <= num_active) &&
+                               (min_degree() >= num_active - 2)))
+      return ActiveShape{kNearClique, num_active,
+                         static_cast<NodeID>(num_missing)};
+    return ActiveShape{};
+  }
+
+  // Largest number of vertices its cliques (with num_pivots) can add
+  NodeID MaxAdded(NodeID num_pivots) const {
+    if (kind == kEdgeless)
+      return num_pivots + std::min(num_active, 1);
+    return num_pivots + num_active - num_missing;
+  }
+
+  // Number of ways to add j vertices from a clique of the active set and
+  // num_pivots pivots, which for a near clique is the coefficient of x^j in
+  // (1+x)^(free vertices + num_pivots) * (1+2x)^num_missing
+  template <typename CountT_>
+  CountT_ Count(const CombCache<CountT_> &n_choose_k, NodeID num_pivots,
+                NodeID j) const {
+    if (j > MaxAdded(num_pivots))
+      return 0;
+    if (kind == kEdgeless) {
+      CountT_ count = n_choose_k(num_pivots, j);
+      if (j > 0)
+        count += CountT_(num_active) * n_choose_k(num_pivots, j-1);
+      return count;
+    }
+    NodeID num_free = num_active - 2 * num_missing + num_pivots;
+    CountT_ count = 0;
+    CountT_ pow_two = 1;
+    for (NodeID i=0; i <= std::min(num_missing, j); i++) {
+      count += n_choose_k(num_missing, i) * pow_two *
+               n_choose_k(num_free, j - i);
+      pow_two *= 2;
+    }
+    return count;
+  }
+};
+
+
+template <typename LocalID_>
+ActiveShape ShapeOf(const SubGraph<LocalID_> &sg) {
+  return ActiveShape::Classify(sg.NumActive(), sg.NumActiveEdges(),
+                               [&sg] { return sg.MinActiveDegree(); });
+}
+
+
+// Adds the cliques of each size (up to max_k) below a node whose active set
+// has a closed form (see ActiveShape)
+template <typename CountT_>
+void AddShapeCounts(const ActiveShape &shape,
+                    const CombCache<CountT_> &n_choose_k, NodeID max_k,
+                    std::vector<CountT_> &counts, NodeID holds,
+                    NodeID pivots) {
+  NodeID max_added = std::min(shape.MaxAdded(pivots), max_k - holds);
+  for (NodeID j=0; j <= max_added; j++)
+    counts[holds + j] += shape.Count(n_choose_k, pivots, j);
+}
+
+
+// Active set of n (at most 64) vertices as bits
+uint64_t AllMaskBits(NodeID n) {
+  return (n == 64) ? ~uint64_t(0) : ((uint64_t(1) << n) - 1);
+}
+
+
+// Counts the cliques of a dense active set as the independent sets of its
+// complement (see ActiveComplementRows), which is sparse
+// - Branches on a vertex with the most complement neighbors, either taking
+//   it (dropping its complement neighbors) or not (dropping only it), until
+//   the complement is a matching or empty, which ActiveShape counts
+// - Not taking the vertex shrinks the active set in place, so each level of
+//   the recursion only needs one active set on the stack
+// - Once the active set fits in a word, continues on bitmasks (as in
+//   PivotRecurseMask)
+template <typename CountT_>
+class ComplementCounter {
+  NodeID num_words_ = 0;
+  // complement neighbors of each vertex (num_words_ each)
+  std::vector<uint64_t> rows_;
+  // active set of each level (num_words_ each)
+  std::vector<uint64_t> stack_;
+  // complement neighbors as bits once the active set fits in a word
+  uint64_t masks_[64];
+
+  const uint64_t* Row(NodeID v) const {
+    return &rows_[int64_t(v) * num_words_];
+  }
+
+  uint64_t* Active(NodeID depth) {
+    return &stack_[int64_t(depth) * num_words_];
+  }
+
+  NodeID NumActive(const uint64_t *active) const {
+    NodeID num_active = 0;
+    for (NodeID w=0; w < num_words_; w++)
+      num_active += std::popcount(active[w]);
+    return num_active;
+  }
+
+  // Has most complement neighbors in active (first if tied), and also
+  // classifies active (see ActiveShape) from the same degrees
+  NodeID FindBranch(const uint64_t *active, ActiveShape &shape) const {
+    NodeID branch = -1;
+    NodeID max_degree = 0;
+    NodeID num_active = 0;
+    int64_t degree_sum = 0;
+    for (NodeID w=0; w < num_words_; w++) {
+      for (uint64_t rest = active[w]; rest != 0; rest &= rest - 1) {
+        NodeID v = w * 64 + std::countr_zero(rest);
+        const uint64_t *row = Row(v);
+        NodeID degree = 0;
+        for (NodeID x=0; x < num_words_; x++)
+          degree += std::popcount(row[x] & active[x]);
+        num_active++;
+        degree_sum += degree;
+        if ((branch == -1) || (degree > max_degree)) {
+          max_degree = degree;
+          branch = v;
+        }
+      }
+    }
+    int64_t num_edges = int64_t(num_active) * (num_active - 1) / 2 -
+                        degree_sum / 2;
+    shape = ActiveShape::Classify(num_active, num_edges,
+        [num_active, max_degree] { return num_active - 1 - max_degree; });
+    return branch;
+  }
+
+  // Active set of the next level: active without branch and its complement
+  // neighbors
+  void TakeBranch(NodeID depth, NodeID branch) {
+    const uint64_t *active = Active(depth);
+    uint64_t *child = Active(depth + 1);
+    const uint64_t *row = Row(branch);
+    for (NodeID w=0; w < num_words_; w++)
+      child[w] = active[w] & ~row[w];
+    child[branch >> 6] &= ~(uint64_t(1) << (branch & 63));
+  }
+
+  void DropBranch(NodeID depth, NodeID branch) {
+    Active(depth)[branch >> 6] &= ~(uint64_t(1) << (branch & 63));
+  }
+
+  // Converts an active set of at most 64 vertices to masks_ (as bits in
+  // vertex order), and returns all of their bits
+  uint64_t ToMasks(const uint64_t *active) {
+    NodeID ids[64];
+    NodeID n = 0;
+    for (NodeID w=0; w < num_words_; w++) {
+      for (uint64_t rest = active[w]; rest != 0; rest &= rest - 1)
+        ids[n++] = w * 64 + std::countr_zero(rest);
+    }
+    for (NodeID i=0; i < n; i++) {
+      const uint64_t *row = Row(ids[i]);
+      uint64_t mask = 0;
+      for (NodeID j=0; j < n; j++)
+        mask |= ((row[ids[j] >> 6] >> (ids[j] & 63)) & 1) << j;
+      masks_[i] = mask;
+    }
+    return AllMaskBits(n);
+  }
+
+  // Bitmask version of FindBranch
+  NodeID FindBranchMask(uint64_t active, ActiveShape &shape) const {
+    NodeID branch = std::countr_zero(active);
+    NodeID max_degree = 0;
+    NodeID num_active = std::popcount(active);
+    int64_t degree_sum = 0;
+    for (uint64_t rest = active; rest != 0; rest &= rest - 1) {
+      NodeID v = std::countr_zero(rest);
+      NodeID degree = std::popcount(masks_[v] & active);
+      degree_sum += degree;
+      if (degree > max_degree) {
+        max_degree = degree;
+        branch = v;
+      }
+    }
+    int64_t num_edges = int64_t(num_active) * (num_active - 1) / 2 -
+                        degree_sum / 2;
+    shape = ActiveShape::Classify(num_active, num_edges,
+        [num_active, max_degree] { return num_active - 1 - max_degree; });
+    return branch;
+  }
+
+  CountT_ CountMask(const CombCache<CountT_> &n_choose_k, uint64_t active,
+                    NodeID k) {
+    CountT_ count = 0;
+    while (true) {
+      if (k == 0)
+        return count + 1;
+      if (std::popcount(active) < k)
+        return count;
+      ActiveShape shape;
+      NodeID branch = FindBranchMask(active, shape);
+      if (shape.kind != ActiveShape::kOther)
+        return count + shape.Count(n_choose_k, 0, k);
+      uint64_t bit = uint64_t(1) << branch;
+      count += CountMask(n_choose_k, active & ~masks_[branch] & ~bit, k-1);
+      active &= ~bit;
+    }
+  }
+
+  void CountSweepMask(const CombCache<CountT_> &n_choose_k, NodeID max_k,
+                      std::vector<CountT_> &counts, uint64_t active,
+                      NodeID holds) {
+    while (true) {
+      if (holds == max_k) {
+        counts[holds] += 1;
+        return;
+      }
+      ActiveShape shape;
+      NodeID branch = FindBranchMask(active, shape);
+      if (shape.kind != ActiveShape::kOther) {
+        AddShapeCounts(shape, n_choose_k, max_k, counts, holds, 0);
+        return;
+      }
+      uint64_t bit = uint64_t(1) << branch;
+      CountSweepMask(n_choose_k, max_k, counts,
+                     active & ~masks_[branch] & ~bit, holds+1);
+      active &= ~bit;
+    }
+  }
+
+ public:
+  // Whether sg has enough active vertices (more than the bitmask kernels
+  // take) with at least min_density of the possible edges among them
+  template <typename LocalID_>
+  static bool Worthwhile(const SubGraph<LocalID_> &sg, double min_density) {
+    NodeID num_active = sg.NumActive();
+    if ((min_density == 0) ||
+        (num_active <= SubGraph<LocalID_>::kMaxMaskVerts))
+      return false;
+    double num_pairs = double(num_active) * (num_active - 1) / 2;
+    return sg.NumActiveEdges() >= min_density * num_pairs;
+  }
+
+  // Takes the complement of the active set of sg
+  template <typename LocalID_>
+  void Load(SubGraph<LocalID_> &sg) {
+    NodeID num_active = sg.NumActive();
+    num_words_ = (num_active + 63) / 64;
+    sg.ActiveComplementRows(rows_, num_words_);
+    // each level drops at least one vertex
+    stack_.assign(int64_t(num_active + 1) * num_words_, 0);
+    uint64_t *active = Active(0);
+    for (NodeID v=0; v < num_active; v++)
+      active[v >> 6] |= uint64_t(1) << (v & 63);
+  }
+
+  // Number of cliques of size k among the loaded active set
+  CountT_ Count(const CombCache<CountT_> &n_choose_k, NodeID k,
+                NodeID depth = 0) {
+    CountT_ count = 0;
+    while (true) {
+      if (k == 0)
+        return count + 1;
+      NodeID num_active = NumActive(Active(depth));
+      if (num_active < k)
+        return count;
+      if (num_active <= 64)
+        return count + CountMask(n_choose_k, ToMasks(Active(depth)), k);
+      ActiveShape shape;
+      NodeID branch = FindBranch(Active(depth), shape);
+      if (shape.kind != ActiveShape::kOther)
+        return count + shape.Count(n_choose_k, 0, k);
+      TakeBranch(depth, branch);
+      count += Count(n_choose_k, k-1, depth+1);
+      DropBranch(depth, branch);
+    }
+  }
+
+  // Adds the cliques among the loaded active set, each with the holds, to
+  // counts (up to max_k)
+  void CountSweep(const CombCache<CountT_> &n_choose_k, NodeID max_k,
+                  std::vector<CountT_> &counts, NodeID holds,
+                  NodeID depth = 0) {
+    while (true) {
+      if (holds == max_k) {
+        counts[holds] += 1;
+        return;
+      }
+      if (NumActive(Active(depth)) <= 64) {
+        CountSweepMask(n_choose_k, max_k, counts, ToMasks(Active(depth)),
+                       holds);
+        return;
+      }
+      ActiveShape shape;
+      NodeID branch = FindBranch(Active(depth), shape);
+      if (shape.kind != ActiveShape::kOther) {
+        AddShapeCounts(shape, n_choose_k, max_k, counts, holds, 0);
+        return;
+      }
+      TakeBranch(depth, branch);
+      CountSweep(n_choose_k, max_k, counts, holds+1, depth+1);
+      DropBranch(depth, branch);
+    }
+  }
+};
+
+
+// Has most neighbors in active (first in bit order if tied), and also
+// classifies active (see ActiveShape) from the same degrees
+NodeID FindPivotMask(const uint64_t *masks, uint64_t active,
+                     ActiveShape &shape) {
+  NodeID pivot = std::countr_zero(active);
+  int max_degree = -1;
+  int min_degree = 64;
+  int64_t degree_sum = 0;
+  for (uint64_t rest = active; rest != 0; rest &= rest - 1) {
+    NodeID v = std::countr_zero(rest);
+    int degree = std::popcount(masks[v] & active);
+    degree_sum += degree;
+    min_degree = std::min(min_degree, degree);
+    if (degree > max_degree) {
+      max_degree = degree;
+      pivot = v;
+    }
+  }
+  shape = ActiveShape::Classify(std::popcount(active), degree_sum / 2,
+                                [min_degree] { return min_degree; });
+  return pivot;
+}
+
+
+// Number of colors of a greedy coloring of active (one independent set of
+// the lowest remaining bits per color)
+NodeID NumColorsMask(const uint64_t *masks, uint64_t active) {
+  NodeID num_colors = 0;
+  while (active != 0) {
+    num_colors++;
+    uint64_t candidates = active;
+    while (candidates != 0) {
+      uint64_t bit = candidates & -candidates;
+      active &= ~bit;
+      candidates &= ~(masks[std::countr_zero(bit)] | bit);
+    }
+  }
+  return num_colors;
+}
+
+
+// Bitmask version of PivotRecurse (below) for subgraphs of at most 64
+// vertices, where masks[i] is the neighbors of vertex (bit) i and active is
+// the P set, so children are just sets of bits and there is nothing to undo
+// - The vertices to induce after the pivot are P & ~N(pivot) (including the
+//   pivot), and each non-pivot child excludes those before it in bit order
+//   (the order of ActiveMasks, not of local IDs, as any fixed order works)
+// - Adds each child searched to num_nodes, as SubGraph counts inductions
+template <typename CountT_>
+CountT_ PivotRecurseMask(const uint64_t *masks, uint64_t active,
+                         const CombCache<CountT_> &n_choose_k, NodeID max_k,
+                         NodeID clique_size, NodeID num_pivots,
+                         int64_t &num_nodes, NodeID color_min_active = 0,
+                         CliqueMemo *memo = nullptr) {
+  NodeID num_active = std::popcount(active);
+  if ((num_active + clique_size) < max_k)
+    return 0;
+  NodeID num_holds = clique_size - num_pivots;
+  if ((active == 0) || (num_holds == max_k))
+    return n_choose_k(num_pivots, max_k - num_holds);
+  if ((memo != nullptr) && memo->Covers(num_active))
+    return memo->Count(masks, active, n_choose_k, num_pivots,
+                       max_k - num_holds);
+  ActiveShape shape;
+  NodeID pivot = FindPivotMask(masks, active, shape);
+  if (shape.kind != ActiveShape::kOther)
+    return shape.Count(n_choose_k, num_pivots, max_k - num_holds);
+  if (color_min_active != 0) {
+    NodeID max_degree = std::popcount(masks[pivot] & active);
+    if ((clique_size + max_degree + 1) < max_k)
+      return 0;
+    if ((num_active >= color_min_active) &&
+        ((clique_size + NumColorsMask(masks, active)) < max_k))
+      return 0;
+  }
+  CountT_ count = 0;
+  uint64_t to_induce = active & ~masks[pivot];
+  num_nodes += std::popcount(to_induce);
+  for (uint64_t rest = to_induce; rest != 0; rest &= rest - 1) {
+    NodeID v = std::countr_zero(rest);
+    if (v == pivot) {
+      count += PivotRecurseMask(masks, active & masks[v], n_choose_k, max_k,
+                                clique_size+1, num_pivots+1, num_nodes,
+                                color_min_active, memo);
+    } else {
+      uint64_t earlier = to_induce & ((uint64_t(1) << v) - 1);
+      count += PivotRecurseMask(masks, active & masks[v] & ~earlier,
+                                n_choose_k, max_k, clique_size+1, num_pivots,
+                                num_nodes, color_min_active, memo);
+    }
+  }
+  return count;
+}
+
+
+// A clique found below has the holds, some of the pivots, and a clique of
+// the active vertices, which is no larger than the max active degree + 1 or
+// the number of colors of a greedy coloring, so if color_min_active is
+// nonzero, prunes with those bounds (coloring only large active sets)
+template <typename CountT_, typename LocalID_>
+CountT_ PivotRecurse(SubGraph<LocalID_> *sg,
+                     const CombCache<CountT_> &n_choose_k, NodeID max_k,
+                     NodeID clique_size, NodeID num_pivots,
+                     NodeID color_min_active = 0,
+                     CliqueMemo *memo = nullptr) {
+  if ((sg->NumActive() + clique_size) < max_k)
+    return 0;
+  NodeID num_holds = clique_size - num_pivots;
+  if (sg->NumActive() == 0 || (num_holds == max_k)) {
+    return n_choose_k(num_pivots, max_k - num_holds);
+  }
+  ActiveShape shape = ShapeOf(*sg);
+  if (shape.kind != ActiveShape::kOther)
+    return shape.Count(n_choose_k, num_pivots, max_k - num_holds);
+  if (sg->NumActive() <= SubGraph<LocalID_>::kMaxMaskVerts) {
+    uint64_t masks[SubGraph<LocalID_>::kMaxMaskVerts];
+    sg->ActiveMasks(masks);
+    int64_t num_nodes = 0;
+    CountT_ count = PivotRecurseMask(masks, AllMaskBits(sg->NumActive()),
+                                     n_choose_k, max_k, clique_size,
+                                     num_pivots, num_nodes, color_min_active,
+                                     memo);
+    sg->AddInductions(num_nodes);
+    return count;
+  }
+  if (auto *child = sg->ShrinkToChild()) {
+    return PivotRecurse(child, n_choose_k, max_k, clique_size, num_pivots,
+                        color_min_active, memo);
+  }
+  NodeID pivot_id_r = sg->FindPivot();
+  if (color_min_active != 0) {
+    // not the pivot's degree, as only the default policy picks the max
+    NodeID max_degree = sg->MaxActiveDegree();
+    if ((clique_size + max_degree + 1) < max_k)
+      return 0;
+    if ((sg->NumActive() >= color_min_active) &&
+        ((clique_size + sg->NumColorsActive()) < max_k))
+      return 0;
+  }
+  CountT_ count = 0;
+  auto verts_to_induce = sg->ActiveUnreachableFromPivot(pivot_id_r);
+  for (NodeID v_r : verts_to_induce) {
+    if (v_r == pivot_id_r) {
+      sg->InduceFromSelfMutate(v_r, {});
+      count += PivotRecurse(sg, n_choose_k, max_k, clique_size+1,
+                            num_pivots+1, color_min_active, memo);
+    } else {
+      sg->InduceFromSelfMutate(v_r, verts_to_induce);
+      count += PivotRecurse(sg, n_choose_k, max_k, clique_size+1,
+                            num_pivots, color_min_active, memo);
+    }
+    sg->UndoSelfMutate();
+  }
+  sg->PopNonNeighbors();
+  return count;
+}
+
+
+// Counts the cliques of size k below a root (or edge task) with clique_size
+// vertices so far, in the complement if dense enough (see ComplementCounter)
+template <typename CountT_, typename LocalID_>
+CountT_ CountInduced(SubGraph<LocalID_> &sg,
+                     ComplementCounter<CountT_> &complement, CliqueMemo *memo,
+                     const CombCache<CountT_> &n_choose_k, NodeID k,
+                     NodeID clique_size,
+                     const PivotCountOptions<CountT_> &opts) {
+  if (ComplementCounter<CountT_>::Worthwhile(sg, opts.complement_density)) {
+    complement.Load(sg);
+    return complement.Count(n_choose_k, k - clique_size);
+  }
+  return PivotRecurse(&sg, n_choose_k, k, clique_size, 0,
+                      opts.color_min_active, memo);
+}
+
+
+template <typename CountT_>
+CountT_ PivotCount(const Graph &dag, NodeID k,
+                   const PivotCountOptions<CountT_> &opts) {
+  CombCache<CountT_> n_choose_k;
+  CountT_ count = 0;
+  RootCheckpoint<CountT_> *ckpt = opts.ckpt;
+  // an edge task starts from clique_size 2, so can't count smaller cliques
+  EdgeTasks<CountT_> edge_tasks(dag, opts, 1, k >= 2);
+  RootTwins twins = FindRootTwins(dag, opts, &edge_tasks);
+  #pragma omp parallel num_threads(opts.NumThreads())
+  {
+    SubGraphByWidth sgs;
+    sgs.SetFlatRows(opts.flat_rows);
+    sgs.SetPivotPolicy(opts.pivot_policy);
+    ComplementCounter<CountT_> complement;
+    CliqueMemo thread_memo(opts.memo_max_verts);
+    CliqueMemo *memo = opts.memo_max_verts ? &thread_memo : nullptr;
+    ProgressMonitor::Slot *slot =
+      opts.progress ? opts.progress->Register() : nullptr;
+    // edge tasks go first, as they come from the costliest roots
+    #pragma omp for reduction(+ : count) schedule(dynamic, 1) nowait
+    for (int64_t t=0; t < edge_tasks.NumTasks(); t++) {
+      NodeID r = edge_tasks.TaskRoot(t);
+      NodeID u = edge_tasks.Root(r);
+      NodeID v = edge_tasks.TaskNeigh(t);
+      int64_t nodes_before = sgs.NumInductions();
+      CountT_ task_count = sgs.Use(dag.out_degree(v), [&](auto &sg) {
+        edge_tasks.Induce(sg, dag, opts, t);
+        return CountInduced(sg, complement, memo, n_choose_k, k, 2, opts);
+      });
+      count += task_count;
+      bool root_finished = edge_tasks.FinishTask(t, &task_count);
+      if ((ckpt != nullptr) && root_finished) {
+        ckpt->FinishRoot(u, edge_tasks.RootCounts(r));
+        ckpt->MaybeSave();
+      }
+      if (slot != nullptr) {
+        slot->PartDone(edge_tasks.TaskCost(t),
+                       sgs.NumInductions() - nodes_before, root_finished);
+      }
+    }
+    #pragma omp for reduction(+ : count) schedule(dynamic, 1)
+    for (NodeID i=0; i < opts.NumRoots(dag); i++) {
+      NodeID v = opts.Root(i);
+      if (edge_tasks.IsSplit(i) || twins.IsMerged(i))
+        continue;
+      if (opts.RootDone(v)) {
+        if (slot != nullptr)
+          slot->RootSkipped(EstimateRootCost(dag, v));
+        continue;
+      }
+      int64_t nodes_before = sgs.NumInductions();
+      CountT_ root_count = sgs.Use(dag.out_degree(v), [&](auto &sg) {
+        opts.Induce(sg, dag, v);
+        return CountInduced(sg, complement, memo, n_choose_k, k, 1, opts);
+      });
+      count += root_count * CountT_(twins.NumTwins(i));
+      // each twin is recorded and reported as if counted itself
+      twins.ForEachTwin(i, [&](NodeID j) {
+        NodeID w = opts.Root(j);
+        if (ckpt != nullptr)
+          ckpt->FinishRoot(w, &root_count);
+        if (slot != nullptr) {
+          slot->RootDone(EstimateRootCost(dag, w),
+              (w == v) ? sgs.NumInductions() - nodes_before : 0);
+        }
+      });
+      if (ckpt != nullptr)
+        ckpt->MaybeSave();
+    }
+    if ((memo != nullptr) && (opts.memo_stats != nullptr))
+      memo->AddStatsTo(*opts.memo_stats);
+    if (opts.tree_nodes != nullptr) {
+      #pragma omp atomic
+      *opts.tree_nodes += sgs.NumInductions();
+    }
+  }
+  if (ckpt != nullptr) {
+    ckpt->Save();
+    count += ckpt->ResumedCounts()[0];
+  }
+  return count;
+}
+
+
+// Bitmask version of the sweep PivotRecurse (see PivotRecurseMask)
+template <typename CountT_>
+void PivotRecurseMask(const uint64_t *masks, uint64_t active,
+                      const CombCache<CountT_> &n_choose_k, NodeID max_k,
+                      std::vector<CountT_> &counts, NodeID clique_size,
+                      NodeID pivots, int64_t &num_nodes,
+                      CliqueMemo *memo = nullptr) {
+  NodeID holds = clique_size - pivots;
+  if ((active == 0) || (holds == max_k)) {
+    for (NodeID p=0; p <= std::min(pivots, max_k - holds); p++) {
+      counts[holds + p] += n_choose_k(pivots, p);
+    }
+    return;
+  }
+  if ((memo != nullptr) && memo->Covers(std::popcount(active))) {
+    memo->AddCounts(masks, active, n_choose_k, max_k, counts, holds, pivots);
+    return;
+  }
+  ActiveShape shape;
+  NodeID pivot = FindPivotMask(masks, active, shape);
+  if (shape.kind != ActiveShape::kOther) {
+    AddShapeCounts(shape, n_choose_k, max_k, counts, holds, pivots);
+    return;
+  }
+  uint64_t to_induce = active & ~masks[pivot];
+  num_nodes += std::popcount(to_induce);
+  for (uint64_t rest = to_induce; rest != 0; rest &= rest - 1) {
+    NodeID v = std::countr_zero(rest);
+    if (v == pivot) {
+      PivotRecurseMask(masks, active & masks[v], n_choose_k, max_k, counts,
+                       clique_size+1, pivots+1, num_nodes, memo);
+    } else {
+      uint64_t earlier = to_induce & ((uint64_t(1) << v) - 1);
+      PivotRecurseMask(masks, active & masks[v] & ~earlier, n_choose_k,
+                       max_k, counts, clique_size+1, pivots, num_nodes, memo);
+    }
+  }
+}
+
+
+template <typename CountT_, typename LocalID_>
+void PivotRecurse(SubGraph<LocalID_> &sg, const CombCache<CountT_> &n_choose_k,
+                  NodeID max_k, std::vector<CountT_> &counts,
+                  NodeID clique_size, NodeID pivots,
+                  CliqueMemo *memo = nullptr) {
+  NodeID holds = clique_size - pivots;
+  if (sg.NumActive() == 0 || (holds == max_k)) {
+    for (NodeID p=0; p <= std::min(pivots, max_k - holds); p++) {
+      counts[holds + p] += n_choose_k(pivots, p);
+    }
+    return;
+  }
+  ActiveShape shape = ShapeOf(sg);
+  if (shape.kind != ActiveShape::kOther) {
+    AddShapeCounts(shape, n_choose_k, max_k, counts, holds, pivots);
+    return;
+  }
+  if (sg.NumActive() <= SubGraph<LocalID_>::kMaxMaskVerts) {
+    uint64_t masks[SubGraph<LocalID_>::kMaxMaskVerts];
+    sg.ActiveMasks(masks);
+    int64_t num_nodes = 0;
+    PivotRecurseMask(masks, AllMaskBits(sg.NumActive()), n_choose_k, max_k,
+                     counts, clique_size, pivots, num_nodes, memo);
+    sg.AddInductions(num_nodes);
+    return;
+  }
+  if (auto *child = sg.ShrinkToChild()) {
+    PivotRecurse(*child, n_choose_k, max_k, counts, clique_size, pivots,
+                 memo);
+    return;
+  }
+  NodeID pivot_id_r = sg.FindPivot();
+  auto verts_to_induce = sg.ActiveUnreachableFromPivot(pivot_id_r);
+  for (NodeID v_r : verts_to_induce) {
+    if (v_r == pivot_id_r) {
+      sg.InduceFromSelfMutate(v_r, {});
+      PivotRecurse(sg, n_choose_k, max_k, counts, clique_size+1, pivots+1,
+                   memo);
+    } else {
+      sg.InduceFromSelfMutate(v_r, verts_to_induce);
+      PivotRecurse(sg, n_choose_k, max_k, counts, clique_size+1, pivots,
+                   memo);
+    }
+    sg.UndoSelfMutate();
+  }
+  sg.PopNonNeighbors();
+}
+
+
+// Sweep version of CountInduced (adds into counts)
+template <typename CountT_, typename LocalID_>
+void CountInduced(SubGraph<LocalID_> &sg,
+                  ComplementCounter<CountT_> &complement, CliqueMemo *memo,
+                  const CombCache<CountT_> &n_choose_k, NodeID max_k,
+                  std::vector<CountT_> &counts, NodeID clique_size,
+                  const PivotCountOptions<CountT_> &opts) {
+  if (ComplementCounter<CountT_>::Worthwhile(sg, opts.complement_density)) {
+    complement.Load(sg);
+    complement.CountSweep(n_choose_k, max_k, counts, clique_size);
+    return;
+  }
+  PivotRecurse(sg, n_choose_k, max_k, counts, clique_size, 0, memo);
+}
+
+
+template <typename CountT_>
+std::vector<CountT_> PivotCountSweep(const Graph &dag, NodeID max_k,
+                                     const PivotCountOptions<CountT_> &opts) {
+  CombCache<CountT_> n_choose_k;
+  std::vector<CountT_> counts(max_k+1, 0);
+  RootCheckpoint<CountT_> *ckpt = opts.ckpt;
+  EdgeTasks<CountT_> edge_tasks(dag, opts, max_k+1, max_k >= 2);
+  // edge tasks only count cliques with at least 2 vertices, so add root
+  for (NodeID r=0; r < edge_tasks.NumRoots(); r++)
+    edge_tasks.RootCounts(r)[1] = 1;
+  RootTwins twins = FindRootTwins(dag, opts, &edge_tasks);
+  #pragma omp parallel num_threads(opts.NumThreads())
+  {
+    SubGraphByWidth sgs;
+    sgs.SetFlatRows(opts.flat_rows);
+    sgs.SetPivotPolicy(opts.pivot_policy);
+    ComplementCounter<CountT_> complement;
+    CliqueMemo thread_memo(opts.memo_max_verts);
+    CliqueMemo *memo = opts.memo_max_verts ? &thread_memo : nullptr;
+    std::vector<CountT_> local_counts(max_k+1, 0);
+    std::vector<CountT_> root_counts(max_k+1, 0);
+    ProgressMonitor::Slot *slot =
+      opts.progress ? opts.progress->Register() : nullptr;
+    #pragma omp for schedule(dynamic, 1) nowait
+    for (int64_t t=0; t < edge_tasks.NumTasks(); t++) {
+      NodeID r = edge_tasks.TaskRoot(t);
+      NodeID u = edge_tasks.Root(r);
+      NodeID v = edge_tasks.TaskNeigh(t);
+      int64_t nodes_before = sgs.NumInductions();
+      std::fill(root_counts.begin(), root_counts.end(), 0);
+      sgs.Use(dag.out_degree(v), [&](auto &sg) {
+        edge_tasks.Induce(sg, dag, opts, t);
+        CountInduced(sg, complement, memo, n_choose_k, max_k, root_counts, 2,
+                     opts);
+      });
+      bool root_finished = edge_tasks.FinishTask(t, root_counts.data());
+      if (root_finished) {
+        for (size_t k=0; k < root_counts.size(); k++)
+          local_counts[k] += edge_tasks.RootCounts(r)[k];
+        if (ckpt != nullptr) {
+          ckpt->FinishRoot(u, edge_tasks.RootCounts(r));
+          ckpt->MaybeSave();
+        }
+      }
+      if (slot != nullptr) {
+        slot->PartDone(edge_tasks.TaskCost(t),
+                       sgs.NumInductions() - nodes_before, root_finished);
+      }
+    }
+    #pragma omp for schedule(dynamic, 1) nowait
+    for (NodeID i=0; i < opts.NumRoots(dag); i++) {
+      NodeID v = opts.Root(i);
+      if (edge_tasks.IsSplit(i) || twins.IsMerged(i))
+        continue;
+      if ((ckpt != nullptr) && ckpt->RootDone(v)) {
+        if (slot != nullptr)
+          slot->RootSkipped(EstimateRootCost(dag, v));
+        continue;
+      }
+      int64_t nodes_before = sgs.NumInductions();
+      auto count_root = [&](std::vector<CountT_> &into) {
+        sgs.Use(dag.out_degree(v), [&](auto &sg) {
+          opts.Induce(sg, dag, v);
+          CountInduced(sg, complement, memo, n_choose_k, max_k, into, 1,
+                       opts);
+        });
+      };
+      NodeID num_twins = twins.NumTwins(i);
+      if ((ckpt == nullptr) && (num_twins == 1)) {
+        count_root(local_counts);
+      } else {
+        // count root separately so its contribution can be recorded (and
+        // added for each of its twins)
+        std::fill(root_counts.begin(), root_counts.end(), 0);
+        count_root(root_counts);
+        for (size_t k=0; k < root_counts.size(); k++)
+          local_counts[k] += root_counts[k] * CountT_(num_twins);
+        if (ckpt != nullptr) {
+          twins.ForEachTwin(i, [&](NodeID j) {
+            ckpt->FinishRoot(opts.Root(j), root_counts.data()); });
+          ckpt->MaybeSave();
+        }
+      }
+      if (slot != nullptr) {
+        twins.ForEachTwin(i, [&](NodeID j) {
+          NodeID w = opts.Root(j);
+          slot->RootDone(EstimateRootCost(dag, w),
+              (w == v) ? sgs.NumInductions() - nodes_before : 0);
+        });
+      }
+    }
+    for (size_t k=0; k < local_counts.size(); k++) {
+      #pragma omp atomic
+      counts[k] += local_counts[k];
+    }
+    if ((memo != nullptr) && (opts.memo_stats != nullptr))
+      memo->AddStatsTo(*opts.memo_stats);
+    if (opts.tree_nodes != nullptr) {
+      #pragma omp atomic
+      *opts.tree_nodes += sgs.NumInductions();
+    }
+  }
+  if (ckpt != nullptr) {
+    ckpt->Save();
+    for (size_t k=0; k < counts.size(); k++)
+      counts[k] += ckpt->ResumedCounts()[k];
+  }
+  return counts;
+}
+
+
+// holds and pivots are the original IDs of the vertices in the clique so far
+// - holds[0] is the root, which is in every clique found, so instead of
+//   adding to its count, returns the number of cliques found
+// - Adds weight times each of the other counts (for a root with twins)
+template <typename CountT_, typename LocalID_>
+CountT_ PivotRecursePerVertex(SubGraph<LocalID_> &sg,
+                              const CombCache<CountT_> &n_choose_k,
+                              NodeID max_k, std::vector<NodeID> &holds,
+                              std::vector<NodeID> &pivots,
+                              std::vector<CountT_> &vertex_counts,
+                              CountT_ weight = 1) {
+  NodeID num_holds = holds.size();
+  NodeID num_pivots = pivots.size();
+  if ((sg.NumActive() + num_holds + num_pivots) < max_k)
+    return 0;
+  if (sg.NumActive() == 0 || (num_holds == max_k)) {
+    // every hold is in all of the cliques, each pivot only in those using it
+    CountT_ hold_count = n_choose_k(num_pivots, max_k - num_holds);
+    for (NodeID h=1; h < num_holds; h++) {
+      #pragma omp atomic
+      vertex_counts[holds[h]] += weight * hold_count;
+    }
+    if (num_holds < max_k) {
+      CountT_ pivot_count = n_choose_k(num_pivots-1, max_k - num_holds - 1);
+      for (NodeID u : pivots) {
+        #pragma omp atomic
+        vertex_counts[u] += weight * pivot_count;
+      }
+    }
+    return hold_count;
+  }
+  if (auto *child = sg.ShrinkToChild()) {
+    return PivotRecursePerVertex(*child, n_choose_k, max_k, holds, pivots,
+                                 vertex_counts, weight);
+  }
+  CountT_ count = 0;
+  NodeID pivot_id_r = sg.FindPivot();
+  auto verts_to_induce = sg.ActiveUnreachableFromPivot(pivot_id_r);
+  for (NodeID v_r : verts_to_induce) {
+    if (v_r == pivot_id_r) {
+      sg.InduceFromSelfMutate(v_r, {});
+      pivots.push_back(sg.OrigID(v_r));
+      count += PivotRecursePerVertex(sg, n_choose_k, max_k, holds, pivots,
+                                     vertex_counts, weight);
+      pivots.pop_back();
+    } else {
+      sg.InduceFromSelfMutate(v_r, verts_to_induce);
+      holds.push_back(sg.OrigID(v_r));
+      count += PivotRecursePerVertex(sg, n_choose_k, max_k, holds, pivots,
+                                     vertex_counts, weight);
+      holds.pop_back();
+    }
+    sg.UndoSelfMutate();
+  }
+  sg.PopNonNeighbors();
+  return count;
+}
+
+
+template <typename CountT_>
+std::vector<CountT_> PivotCountPerVertex(const Graph &dag, NodeID k,
+    const PivotCountOptions<CountT_> &opts) {
+  CombCache<CountT_> n_choose_k;
+  std::vector<CountT_> vertex_counts(dag.num_nodes(), 0);
+  RootTwins twins = FindRootTwins(dag, opts);
+  #pragma omp parallel num_threads(opts.NumThreads())
+  {
+    SubGraphByWidth sgs;
+    std::vector<NodeID> holds, pivots;
+    #pragma omp for schedule(dynamic, 1)
+    for (NodeID i=0; i < opts.NumRoots(dag); i++) {
+      if (twins.IsMerged(i))
+        continue;
+      NodeID v = opts.Root(i);
+      holds.assign(1, v);
+      pivots.clear();
+      // twins share every clique below except the root itself
+      CountT_ root_count = sgs.Use(dag.out_degree(v), [&](auto &sg) {
+        opts.Induce(sg, dag, v);
+        return PivotRecursePerVertex(sg, n_choose_k, k, holds, pivots,
+                                     vertex_counts,
+                                     CountT_(twins.NumTwins(i)));
+      });
+      twins.ForEachTwin(i, [&](NodeID j) {
+        #pragma omp atomic
+        vertex_counts[opts.Root(j)] += root_count;
+      });
+    }
+  }
+  return vertex_counts;
+}
+
+
+// Shared by all threads listing cliques, to stop early or at a limit
+struct ListState {
+  int64_t max_cliques;
+  int64_t num_claimed = 0;
+  std::atomic<bool> stopped{false};
+
+  explicit ListState(int64_t limit) : max_cliques(limit) {}
+
+  bool Claim() {
+    if (max_cliques == 0)
+      return true;
+    if (fetch_and_add(num_claimed, 1) < max_cliques)
+      return true;
+    stopped.store(true, std::memory_order_relaxed);
+    return false;
+  }
+};
+
+
+// Emits every clique made of clique (holds and pivots chosen so far) and
+// enough of the pivots from first onward to reach max_k
+template <typename EmitF_>
+bool EmitLeafCliques(NodeID max_k, const std::vector<NodeID> &pivots,
+                     NodeID first, std::vector<NodeID> &clique, EmitF_ &emit,
+                     ListState &state, int64_t &num_listed) {
+  NodeID num_needed = max_k - clique.size();
+  if (num_needed == 0) {
+    if (state.stopped.load(std::memory_order_relaxed) || !state.Claim())
+      return false;
+    if (!emit(std::span<const NodeID>(clique))) {
+      state.stopped.store(true, std::memory_order_relaxed);
+      return false;
+    }
+    num_listed++;
+    return true;
+  }
+  NodeID num_pivots = pivots.size();
+  for (NodeID i=first; i <= num_pivots - num_needed; i++) {
+    clique.push_back(pivots[i]);
+    bool more = EmitLeafCliques(max_k, pivots, i+1, clique, emit, state,
+                                num_listed);
+    clique.pop_back();
+    if (!more)
+      return false;
+  }
+  return true;
+}
+
+
+// holds and pivots are the original IDs of the vertices in the clique so far,
+// returns false once listing has stopped (sg is then left mid-recursion)
+template <typename LocalID_, typename EmitF_>
+bool PivotRecurseList(SubGraph<LocalID_> &sg, NodeID max_k,
+                      std::vector<NodeID> &holds, std::vector<NodeID> &pivots,
+                      std::vector<NodeID> &clique, EmitF_ &emit,
+                      ListState &state, int64_t &num_listed) {
+  NodeID num_holds = holds.size();
+  NodeID num_pivots = pivots.size();
+  if ((sg.NumActive() + num_holds + num_pivots) < max_k)
+    return true;
+  if (sg.NumActive() == 0 || (num_holds == max_k)) {
+    clique.assign(holds.begin(), holds.end());
+    return EmitLeafCliques(max_k, pivots, 0, clique, emit, state, num_listed);
+  }
+  if (auto *child = sg.ShrinkToChild()) {
+    return PivotRecurseList(*child, max_k, holds, pivots, clique, emit, state,
+                            num_listed);
+  }
+  NodeID pivot_id_r = sg.FindPivot();
+  auto verts_to_induce = sg.ActiveUnreachableFromPivot(pivot_id_r);
+  for (NodeID v_r : verts_to_induce) {
+    bool more;
+    if (v_r == pivot_id_r) {
+      sg.InduceFromSelfMutate(v_r, {});
+      pivots.push_back(sg.OrigID(v_r));
+      more = PivotRecurseList(sg, max_k, holds, pivots, clique, emit, state,
+                              num_listed);
+      pivots.pop_back();
+    } else {
+      sg.InduceFromSelfMutate(v_r, verts_to_induce);
+      holds.push_back(sg.OrigID(v_r));
+      more = PivotRecurseList(sg, max_k, holds, pivots, clique, emit, state,
+                              num_listed);
+      holds.pop_back();
+    }
+    if (!more)
+      return false;
+    sg.UndoSelfMutate();
+  }
+  sg.PopNonNeighbors();
+  return true;
+}
+
+
+// Calls emit(clique) concurrently from all threads for each k-clique (with
+// its vertices in no particular order) until emit returns false or max_cliques
+// (if nonzero) have been listed, and returns the number listed
+template <typename CountT_, typename EmitF_>
+int64_t PivotList(const Graph &dag, NodeID k, int64_t max_cliques,
+                  const PivotCountOptions<CountT_> &opts, EmitF_ emit) {
+  ListState state(max_cliques);
+  int64_t num_listed = 0;
+  #pragma omp parallel reduction(+ : num_listed) \
+    num_threads(opts.NumThreads())
+  {
+    SubGraphByWidth sgs;
+    std::vector<NodeID> holds, pivots, clique;
+    #pragma omp for schedule(dynamic, 1)
+    for (NodeID i=0; i < opts.NumRoots(dag); i++) {
+      if (state.stopped.load(std::memory_order_relaxed))
+        continue;
+      NodeID v = opts.Root(i);
+      holds.assign(1, v);
+      pivots.clear();
+      sgs.Use(dag.out_degree(v), [&](auto &sg) {
+        opts.Induce(sg, dag, v);
+        PivotRecurseList(sg, k, holds, pivots, clique, emit, state,
+                         num_listed);
+      });
+    }
+  }
+  return num_listed;
+}
+
+// Calls leaf(holds, pivots) for each leaf of the complete (no k) pivot tree
+template <typename LocalID_, typename LeafF_>
+void PivotRecurseLeaves(SubGraph<LocalID_> &sg, std::vector<NodeID> &holds,
+                        std::vector<NodeID> &pivots, LeafF_ &leaf) {
+  if (sg.NumActive() == 0) {
+    leaf(std::span<const NodeID>(holds), std::span<const NodeID>(pivots));
+    return;
+  }
+  if (auto *child = sg.ShrinkToChild()) {
+    PivotRecurseLeaves(*child, holds, pivots, leaf);
+    return;
+  }
+  NodeID pivot_id_r = sg.FindPivot();
+  auto verts_to_induce = sg.ActiveUnreachableFromPivot(pivot_id_r);
+  for (NodeID v_r : verts_to_induce) {
+    if (v_r == pivot_id_r) {
+      sg.InduceFromSelfMutate(v_r, {});
+      pivots.push_back(sg.OrigID(v_r));
+      PivotRecurseLeaves(sg, holds, pivots, leaf);
+      pivots.pop_back();
+    } else {
+      sg.InduceFromSelfMutate(v_r, verts_to_induce);
+      holds.push_back(sg.OrigID(v_r));
+      PivotRecurseLeaves(sg, holds, pivots, leaf);
+      holds.pop_back();
+    }
+    sg.UndoSelfMutate();
+  }
+  sg.PopNonNeighbors();
+}
+
+
+// Calls leaf(holds, pivots) concurrently from all threads for each leaf of
+// the pivot tree (in original vertex IDs), where every clique is the holds
+// of exactly one leaf with some of that leaf's pivots
+template <typename CountT_, typename LeafF_>
+void PivotLeaves(const Graph &dag, const PivotCountOptions<CountT_> &opts,
+                 LeafF_ leaf) {
+  #pragma omp parallel num_threads(opts.NumThreads())
+  {
+    SubGraphByWidth sgs;
+    std::vector<NodeID> holds, pivots;
+    #pragma omp for schedule(dynamic, 1)
+    for (NodeID i=0; i < opts.NumRoots(dag); i++) {
+      NodeID v = opts.Root(i);
+      holds.assign(1, v);
+      pivots.clear();
+      sgs.Use(dag.out_degree(v), [&](auto &sg) {
+        opts.Induce(sg, dag, v);
+        PivotRecurseLeaves(sg, holds, pivots, leaf);
+      });
+    }
+  }
+}
+
+
+// Runs count(opts) once per pivot policy (with opts otherwise as given, but
+// without checkpoint or progress), printing the pivot tree nodes searched
+// and time taken by each before passing its result to report, so one
+// policy can be picked per family of graphs, and returns whether every
+// policy got the same result (as the pivot rule should never change it)
+template <typename CountT_, typename CountF_, typename ReportF_>
+bool ComparePivotPolicies(PivotCountOptions<CountT_> opts, CountF_ count,
+                          ReportF_ report) {
+  opts.ckpt = nullptr;
+  opts.progress = nullptr;
+  decltype(count(opts)) first_result{};
+  bool all_agree = true;
+  for (int p=0; p < kNumPivotPolicies; p++) {
+    int64_t tree_nodes = 0;
+    opts.pivot_policy = static_cast<PivotPolicy>(p);
+    opts.tree_nodes = &tree_nodes;
+    Timer t;
+    t.Start();
+    auto result = count(opts);
+    t.Stop();
+    PrintLabel("Pivot Policy", kPivotPolicyNames[p]);
+    PrintStep("Tree Nodes", tree_nodes);
+    PrintTime("Counting Time", t.Seconds());
+    report(result);
+    if (p == 0) {
+      first_result = result;
+    } else if (result != first_result) {
+      std::cout << "Counts differ from pivot policy " << kPivotPolicyNames[0];
+      std::cout << std::endl;
+      all_agree = false;
+    }
+  }
+  return all_agree;
+}
+
+#endif  // PIVOT_COUNT_H_
@@ -0,0 +1,324 @@
+// Copyright (c) 2025, The Regents of the University of California (Regents)
+// See LICENSE for license details
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hash_table8.hpp"
+#include "pivot_count.h"
+
+
+/*
+PivotScale
+File:   PivotScale-Dynamic
+Author: Amogh Lonkar, Scott Beamer
+
+Maintains counts of cliques of all sizes up to k as the graph changes by
+batches of edge insertions and deletions
+- Only counts cliques containing a changed edge (u, v), which are the cliques
+  of the common neighborhood of u and v, so the pivot recursion starts from
+  that neighborhood with u and v already held
+- Each batch is reduced to its net edge changes, then deletions are counted
+  before they are removed and insertions after they are added, with the i-th
+  changed edge skipping cliques that contain an earlier changed edge (so the
+  changed edges can be counted in parallel without double counting)
+- If the estimated work of a batch exceeds the estimated work of counting
+  from scratch, recounts from scratch instead
+*/
+
+
+struct EdgeUpdate {
+  NodeID u;
+  NodeID v;
+  bool insert;
+};
+
+
+// Batches are terminated by blank lines, and lines starting with # ignored
+std::vector<std::vector<EdgeUpdate>> ReadUpdateBatches(
+    const std::string &filename) {
+  std::ifstream file(filename);
+  if (!file) {
+    std::cout << "Couldn't open file " << filename << std::endl;
+    std::exit(-2);
+  }
+  std::vector<std::vector<EdgeUpdate>> batches(1);
+  std::string line;
+  int64_t line_num = 0;
+  while (std::getline(file, line)) {
+    line_num++;
+    std::istringstream in(line);
+    std::string op;
+    if (!(in >> op)) {
+      if (!batches.back().empty())
+        batches.emplace_back();
+      continue;
+    }
+    if (op[0] == '#')
+      continue;
+    int64_t u, v;
+    if (((op != "+") && (op != "-")) || !(in >> u >> v) || (u < 0) ||
+        (v < 0) || (u >= INT32_MAX) || (v >= INT32_MAX)) {
+      std::cout << "Invalid update on line " << line_num << " of " << filename;
+      std::cout << std::endl;
+      std::exit(-9);
+    }
+    batches.back().push_back({static_cast<NodeID>(u), static_cast<NodeID>(v),
+                              op == "+"});
+  }
+  if (batches.back().empty())
+    batches.pop_back();
+  return batches;
+}
+
+
+class DynamicCliqueCounts {
+  const Builder &b_;
+  NodeID max_k_;
+  CombCache<count_t> n_choose_k_;
+  // undirected graph with sorted neighbors
+  std::vector<std::vector<NodeID>> adj_;
+  int64_t num_edges_ = 0;
+  int64_t sum_sq_degrees_ = 0;
+  std::vector<count_t> counts_;
+
+  static uint64_t EdgeKey(NodeID u, NodeID v) {
+    if (u > v)
+      std::swap(u, v);
+    return (static_cast<uint64_t>(u) << 32) | static_cast<uint64_t>(v);
+  }
+
+  NodeID NumNodes() const {
+    return adj_.size();
+  }
+
+  int64_t Degree(NodeID u) const {
+    return adj_[u].size();
+  }
+
+  bool HasEdge(NodeID u, NodeID v) const {
+    if ((u >= NumNodes()) || (v >= NumNodes()))
+      return false;
+    return std::binary_search(adj_[u].begin(), adj_[u].end(), v);
+  }
+
+  void AddEdge(NodeID u, NodeID v) {
+    sum_sq_degrees_ += 2*Degree(u) + 1 + 2*Degree(v) + 1;
+    adj_[u].insert(std::lower_bound(adj_[u].begin(), adj_[u].end(), v), v);
+    adj_[v].insert(std::lower_bound(adj_[v].begin(), adj_[v].end(), u), u);
+    num_edges_++;
+  }
+
+  void RemoveEdge(NodeID u, NodeID v) {
+    sum_sq_degrees_ -= 2*Degree(u) - 1 + 2*Degree(v) - 1;
+    adj_[u].erase(std::lower_bound(adj_[u].begin(), adj_[u].end(), v));
+    adj_[v].erase(std::lower_bound(adj_[v].begin(), adj_[v].end(), u));
+    num_edges_--;
+  }
+
+  // New vertices are 1-cliques
+  void AddVertices(NodeID num_nodes) {
+    if (num_nodes > NumNodes()) {
+      counts_[1] += num_nodes - NumNodes();
+      adj_.resize(num_nodes);
+    }
+  }
+
+  // Intersecting the neighborhoods, then recursing on at most the smaller one
+  int64_t EstimateEdgeCost(NodeID u, NodeID v) const {
+    int64_t d_u = (u < NumNodes()) ? Degree(u) : 0;
+    int64_t d_v = (v < NumNodes()) ? Degree(v) : 0;
+    int64_t d_min = std::min(d_u, d_v);
+    return 1 + d_u + d_v + d_min * d_min;
+  }
+
+  // Like EstimateRootCost, with each out-degree about half the degree
+  int64_t EstimateRecountCost() const {
+    return NumNodes() + 2*num_edges_ + sum_sq_degrees_ / 4;
+  }
+
+  Graph MakeGraph() const {
+    pvector<NodeID> degrees(NumNodes());
+    #pragma omp parallel for
+    for (NodeID u=0; u < NumNodes(); u++)
+      degrees[u] = Degree(u);
+    pvector<SGOffset> offsets = Builder::ParallelPrefixSum(degrees);
+    NodeID *neighs = new NodeID[offsets[NumNodes()]];
+    NodeID **index = Graph::GenIndex(offsets, neighs);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID u=0; u < NumNodes(); u++)
+      std::copy(adj_[u].begin(), adj_[u].end(), index[u]);
+    return Graph(NumNodes(), index, neighs);
+  }
+
+  void CountFromScratch(const Graph &g) {
+    Graph dag = Ordering::Directionalize(g, b_);
+    PivotCountOptions<count_t> opts;
+    counts_ = PivotCountSweep(dag, max_k_, opts);
+  }
+
+  // Counts cliques containing each changed edge in the current graph, but
+  // leaves cliques that also contain an earlier changed edge to that edge
+  std::vector<count_t> CountChangedEdges(
+      const std::vector<std::pair<NodeID, NodeID>> &changed) const {
+    emhash8::HashMap<uint64_t, int64_t> position;
+    position.reserve(changed.size());
+    for (size_t i=0; i < changed.size(); i++)
+      position.emplace_unique(EdgeKey(changed[i].first, changed[i].second), i);
+    std::vector<count_t> delta(max_k_+1, 0);
+    #pragma omp parallel
+    {
+      SubGraph<> sg;
+      std::vector<NodeID> common;
+      std::vector<count_t> local_delta(max_k_+1, 0);
+      #pragma omp for schedule(dynamic, 1) nowait
+      for (size_t i=0; i < changed.size(); i++) {
+        auto [u, v] = changed[i];
+        int64_t pos = i;
+        auto changed_earlier = [&position, pos](NodeID a, NodeID b) {
+          auto it = position.find(EdgeKey(a, b));
+          return (it != position.end()) && (it->second < pos);
+        };
+        common.clear();
+        std::set_intersection(adj_[u].begin(), adj_[u].end(), adj_[v].begin(),
+                              adj_[v].end(), std::back_inserter(common));
+        std::erase_if(common, [&](NodeID w) {
+          return changed_earlier(u, w) || changed_earlier(v, w); });
+        sg.InduceFromSet(common,
+          [this](NodeID w) -> const std::vector<NodeID>& { return adj_[w]; },
+          [&](NodeID a, NodeID b) { return !changed_earlier(a, b); });
+        PivotRecurse(sg, n_choose_k_, max_k_, local_delta, 2, 0);
+      }
+      for (size_t k=0; k < local_delta.size(); k++) {
+        #pragma omp atomic
+        delta[k] += local_delta[k];
+      }
+    }
+    return delta;
+  }
+
+ public:
+  DynamicCliqueCounts(const Builder &b, const Graph &g, NodeID max_k) :
+      b_(b), max_k_(max_k), adj_(g.num_nodes()) {
+    #pragma omp parallel for reduction(+ : sum_sq_degrees_)
+    for (NodeID u=0; u < g.num_nodes(); u++) {
+      adj_[u].assign(g.out_neigh(u).begin(), g.out_neigh(u).end());
+      sum_sq_degrees_ += Degree(u) * Degree(u);
+    }
+    num_edges_ = g.num_edges();
+    CountFromScratch(g);
+  }
+
+  // Returns false if the batch was handled by recounting from scratch
+  bool ApplyBatch(const std::vector<EdgeUpdate> &batch, int64_t *num_inserted,
+                  int64_t *num_deleted) {
+    // last update of each edge determines whether it is in the graph after
+    emhash8::HashMap<uint64_t, bool> final_state;
+    std::vector<std::pair<NodeID, NodeID>> touched;
+    NodeID new_num_nodes = NumNodes();
+    for (const EdgeUpdate &e : batch) {
+      if (e.u == e.v)
+        continue;
+      auto it = final_state.find(EdgeKey(e.u, e.v));
+      if (it == final_state.end()) {
+        final_state.emplace_unique(EdgeKey(e.u, e.v), e.insert);
+        touched.emplace_back(e.u, e.v);
+      } else {
+        it->second = e.insert;
+      }
+      if (e.insert)
+        new_num_nodes = std::max(new_num_nodes, std::max(e.u, e.v) + 1);
+    }
+    std::vector<std::pair<NodeID, NodeID>> inserted, deleted;
+    int64_t batch_cost = 0;
+    for (auto [u, v] : touched) {
+      bool present = HasEdge(u, v);
+      bool in_final = final_state[EdgeKey(u, v)];
+      if (in_final && !present)
+        inserted.emplace_back(u, v);
+      if (!in_final && present)
+        deleted.emplace_back(u, v);
+      if (in_final != present)
+        batch_cost += EstimateEdgeCost(u, v);
+    }
+    *num_inserted = inserted.size();
+    *num_deleted = deleted.size();
+    AddVertices(new_num_nodes);
+
+    if (batch_cost > EstimateRecountCost()) {
+      for (auto [u, v] : deleted)
+        RemoveEdge(u, v);
+      for (auto [u, v] : inserted)
+        AddEdge(u, v);
+      CountFromScratch(MakeGraph());
+      return false;
+    }
+    std::vector<count_t> lost = CountChangedEdges(deleted);
+    for (auto [u, v] : deleted)
+      RemoveEdge(u, v);
+    for (auto [u, v] : inserted)
+      AddEdge(u, v);
+    std::vector<count_t> gained = CountChangedEdges(inserted);
+    for (NodeID k=0; k <= max_k_; k++)
+      counts_[k] += gained[k] - lost[k];
+    return true;
+  }
+
+  const std::vector<count_t>& counts() const {
+    return counts_;
+  }
+
+  int64_t num_edges() const {
+    return num_edges_;
+  }
+};
+
+
+int main(int argc, char* argv[]) {
+  CLDynamic cli(argc, argv, "PivotScale dynamic clique counts");
+  if (!cli.ParseArgs()) {
+    return -1;
+  }
+  std::vector<std::vector<EdgeUpdate>> batches =
+    ReadUpdateBatches(cli.updates_file());
+  Builder b(cli);
+  Graph g = b.MakeGraph();
+  if (g.directed()) {
+    std::cout << "Input graph is directed but clique counting requires";
+    std::cout << " undirected" << std::endl;
+    std::exit(-2);
+  }
+  Timer t;
+  t.Start();
+  DynamicCliqueCounts dynamic(b, g, cli.clique_size());
+  t.Stop();
+  g = Graph();
+  PrintTime("Initial Count Time", t.Seconds());
+  PrintCliqueCounts(dynamic.counts());
+
+  double update_time = 0;
+  for (size_t i=0; i < batches.size(); i++) {
+    int64_t num_inserted, num_deleted;
+    t.Start();
+    bool incremental = dynamic.ApplyBatch(batches[i], &num_inserted,
+                                          &num_deleted);
+    t.Stop();
+    update_time += t.Seconds();
+    std::cout << "Batch " << i << ": " << num_inserted << " inserted, ";
+    std::cout << num_deleted << " deleted, ";
+    std::cout << (incremental ? "incremental" : "recounted") << std::endl;
+    PrintTime("Update Time", t.Seconds());
+    printf("k: ");
+    PrintCliqueCountRow(cli.clique_size(), dynamic.counts()[cli.clique_size()]);
+  }
+  PrintStep("Batches", static_cast<int64_t>(batches.size()));
+  PrintStep("Final Edges", dynamic.num_edges());
+  PrintTime("Total Update Time", update_time);
+  PrintCliqueCounts(dynamic.counts());
+  return 0;
+}
@@ -0,0 +1,84 @@
+// Copyright (c) 2025, The Regents of the University of California (Regents)
+// See LICENSE for license details
+
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "clique_writer.h"
+#include "pivot_count.h"
+
+
+/*
+PivotScale
+File:   PivotScale-List
+Author: Amogh Lonkar, Scott Beamer
+
+Lists the cliques of size k (in original vertex IDs)
+- Each thread writes the cliques it finds to its own file (prefix.<thread>)
+  through a CliqueWriter, so memory use is bounded
+- Binary output is k 32-bit vertex IDs per clique, and text output is one
+  clique per line
+- Without an output prefix, only counts the cliques it would list
+*/
+
+
+int main(int argc, char* argv[]) {
+  CLList cli(argc, argv, "PivotScale clique listing");
+  if (!cli.ParseArgs()) {
+    return -1;
+  }
+  Builder b(cli);
+  Timer t;
+  Graph dag;
+  {  // restricted scope to trigger deletion of g for memory savings
+    Graph g = b.MakeGraph();
+    if (g.directed()) {
+      std::cout << "Input graph is directed but clique listing requires";
+      std::cout << " undirected" << std::endl;
+      std::exit(-2);
+    }
+    t.Start();
+    dag = Ordering::Directionalize(g, b);
+    t.Stop();
+  }
+
+  double direct_time = t.Seconds();
+  dag.PrintStats();
+  PrintTime("Directing Time", direct_time);
+
+  std::vector<std::unique_ptr<CliqueWriter>> writers;
+  if (cli.output_prefix() != "") {
+    for (int i=0; i < MaxThreads(); i++) {
+      writers.push_back(std::make_unique<CliqueWriter>(
+        cli.output_prefix() + "." + std::to_string(i), cli.clique_size(),
+        cli.text()));
+    }
+  }
+  auto emit = [&writers](std::span<const NodeID> clique) {
+    return writers.empty() || writers[ThreadNum()]->Write(clique);
+  };
+
+  t.Start();
+  PivotCountOptions<count_t> opts;
+  int64_t num_listed = PivotList(dag, cli.clique_size(), cli.max_cliques(),
+                                 opts, emit);
+  for (auto &writer : writers) {
+    if (!writer->Flush()) {
+      std::cout << "Couldn't write cliques to " << cli.output_prefix();
+      std::cout << ".*" << std::endl;
+      std::exit(-6);
+    }
+  }
+  writers.clear();
+  t.Stop();
+  double list_time = t.Seconds();
+
+  PrintTime("Listing Time", list_time);
+  PrintTime("Total Time", direct_time + list_time);
+  PrintStep("Cliques Listed", num_listed);
+  if ((cli.max_cliques() > 0) && (num_listed == cli.max_cliques()))
+    std::cout << "Stopped at limit of " << cli.max_cliques() << std::endl;
+  return 0;
+}
@@ -0,0 +1,146 @@
+// Copyright (c) 2025, The Regents of the University of California (Regents)
+// See LICENSE for license details
+
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "clique_writer.h"
+#include "pivotscale.h"
+
+
+/*
+PivotScale
+File:   PivotScale-Maximal
+Author: Amogh Lonkar, Scott Beamer
+
+Counts (and optionally lists) the maximal cliques with a pivoted
+Bron-Kerbosch search on SubGraph
+- Graph is directed by (approximate) degeneracy ordering, and each root's
+  search starts with its out-neighbors as P and its in-neighbors as X
+- Pivot is the vertex of P or X with the most neighbors in P, and a clique
+  is maximal when both P and X are empty
+- Reports the number of maximal cliques of each size
+*/
+
+
+template <typename EmitF_>
+void MaximalRecurse(SubGraph<> &sg, std::vector<NodeID> &clique,
+                    std::vector<int64_t> &size_counts, EmitF_ &emit) {
+  if (sg.NumActive() == 0) {
+    if (sg.NumExcluded() == 0) {
+      if (clique.size() >= size_counts.size())
+        size_counts.resize(clique.size() + 1, 0);
+      size_counts[clique.size()]++;
+      emit(std::span<const NodeID>(clique));
+    }
+    return;
+  }
+  NodeID pivot_id_r = sg.FindPivotWithExcluded();
+  auto verts_to_induce = sg.ActiveUnreachableFromPivot(pivot_id_r);
+  for (NodeID v_r : verts_to_induce) {
+    sg.InduceFromSelfMutateWithExcluded(v_r, verts_to_induce);
+    clique.push_back(sg.OrigID(v_r));
+    MaximalRecurse(sg, clique, size_counts, emit);
+    clique.pop_back();
+    sg.UndoSelfMutateWithExcluded();
+  }
+  sg.PopNonNeighbors();
+}
+
+
+template <typename EmitF_>
+std::vector<int64_t> MaximalCliques(const Graph &g, const Graph &dag,
+                                    EmitF_ emit) {
+  std::vector<int64_t> size_counts;
+  #pragma omp parallel
+  {
+    SubGraph<> sg;
+    std::vector<NodeID> clique;
+    std::vector<int64_t> local_counts;
+    #pragma omp for schedule(dynamic, 1) nowait
+    for (NodeID u=0; u < dag.num_nodes(); u++) {
+      sg.InduceFromDAGWithExcluded(g, dag, u);
+      clique.assign(1, u);
+      MaximalRecurse(sg, clique, local_counts, emit);
+    }
+    #pragma omp critical
+    {
+      if (local_counts.size() > size_counts.size())
+        size_counts.resize(local_counts.size(), 0);
+      for (size_t k=0; k < local_counts.size(); k++)
+        size_counts[k] += local_counts[k];
+    }
+  }
+  return size_counts;
+}
+
+
+int main(int argc, char* argv[]) {
+  CLMaximal cli(argc, argv, "PivotScale maximal clique enumeration");
+  if (!cli.ParseArgs()) {
+    return -1;
+  }
+  Builder b(cli);
+  Graph g = b.MakeGraph();
+  if (g.directed()) {
+    std::cout << "Input graph is directed but clique enumeration requires";
+    std::cout << " undirected" << std::endl;
+    std::exit(-2);
+  }
+  Timer t;
+  t.Start();
+  double epsilon = -0.5;
+  std::vector<NodeID> ranking = Ordering::CoreApprox(g, epsilon);
+  Graph dag = Builder::DirectGraphCore(g, ranking);
+  t.Stop();
+  double direct_time = t.Seconds();
+  dag.PrintStats();
+  PrintStep("Max Out-Degree",
+            static_cast<int64_t>(Ordering::FindMaxDegree(dag)));
+  PrintTime("Directing Time", direct_time);
+
+  std::vector<std::unique_ptr<CliqueWriter>> writers;
+  if (cli.output_prefix() != "") {
+    for (int i=0; i < MaxThreads(); i++) {
+      writers.push_back(std::make_unique<CliqueWriter>(
+        cli.output_prefix() + "." + std::to_string(i),
+        Ordering::FindMaxDegree(dag) + 1, cli.text()));
+    }
+  }
+  auto emit = [&writers](std::span<const NodeID> clique) {
+    if (!writers.empty())
+      writers[ThreadNum()]->Write(clique);
+  };
+
+  t.Start();
+  std::vector<int64_t> size_counts = MaximalCliques(g, dag, emit);
+  for (auto &writer : writers) {
+    if (!writer->Flush()) {
+      std::cout << "Couldn't write cliques to " << cli.output_prefix();
+      std::cout << ".*" << std::endl;
+      std::exit(-6);
+    }
+  }
+  writers.clear();
+  t.Stop();
+  double enum_time = t.Seconds();
+
+  int64_t num_maximal = 0;
+  for (int64_t count : size_counts)
+    num_maximal += count;
+  PrintTime("Enumeration Time", enum_time);
+  PrintTime("Total Time", direct_time + enum_time);
+  PrintStep("Maximal Cliques", num_maximal);
+  PrintStep("Largest Clique",
+            static_cast<int64_t>(size_counts.empty() ? 0 :
+                                 size_counts.size() - 1));
+  printf("   k |      maximal cliques\n");
+  printf("--------------------------\n");
+  for (size_t k=0; k < size_counts.size(); k++) {
+    if (size_counts[k] != 0)
+      printf("%4zu %21" PRId64 "\n", k, size_counts[k]);
+  }
+  return 0;
+}
@@ -0,0 +1,134 @@
+// Copyright (c) 2025, The Regents of the University of California (Regents)
+// See LICENSE for license details
+
+#include <cinttypes>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "checkpoint.h"
+#include "pivotscale.h"
+
+
+/*
+PivotScale
+File:   PivotScale-Merge
+Author: Amogh Lonkar, Scott Beamer
+
+Combines partial results (from sharded runs with -S i/n -p file) into the
+total count
+- All partial results must be for the same graph, clique size, and counting
+  mode, but may use different count widths (sums are always 128-bit)
+- Checks every root block is counted by exactly one partial result
+*/
+
+
+struct PartialResult {
+  CountFileHeader header;
+  std::vector<uint8_t> done;
+  std::vector<unsigned __int128> counts;
+};
+
+
+PartialResult ReadPartialResult(const std::string &filename) {
+  PartialResult part;
+  std::ifstream file(filename, std::ios::in | std::ios::binary);
+  if (!file) {
+    std::cout << "Couldn't open file " << filename << std::endl;
+    std::exit(-2);
+  }
+  file.read(reinterpret_cast<char*>(&part.header), sizeof(part.header));
+  if (!file || (part.header.magic != CountFileHeader::kMagic) ||
+      ((part.header.count_bytes != 8) && (part.header.count_bytes != 16))) {
+    std::cout << filename << " is not a partial result file" << std::endl;
+    std::exit(-9);
+  }
+  part.done.resize(part.header.num_blocks);
+  file.read(reinterpret_cast<char*>(part.done.data()), part.header.num_blocks);
+  for (int32_t i=0; i < part.header.num_counts; i++) {
+    if (part.header.count_bytes == 8) {
+      uint64_t count;
+      file.read(reinterpret_cast<char*>(&count), sizeof(count));
+      part.counts.push_back(count);
+    } else {
+      unsigned __int128 count;
+      file.read(reinterpret_cast<char*>(&count), sizeof(count));
+      part.counts.push_back(count);
+    }
+  }
+  if (!file) {
+    std::cout << filename << " is truncated" << std::endl;
+    std::exit(-9);
+  }
+  return part;
+}
+
+
+bool SameProblem(const CountFileHeader &a, const CountFileHeader &b) {
+  return (a.num_nodes == b.num_nodes) && (a.num_edges == b.num_edges) &&
+         (a.k == b.k) && (a.num_counts == b.num_counts) &&
+         (a.block_size == b.block_size) && (a.num_blocks == b.num_blocks);
+}
+
+
+void PrintMergedRow(size_t k, unsigned __int128 count) {
+  printf("%4zu ", k);
+  Print_uint128(count);
+  printf("\n");
+}
+
+
+int main(int argc, char* argv[]) {
+  if ((argc < 2) || (strcmp(argv[1], "-h") == 0)) {
+    std::cout << "PivotScale partial result merge" << std::endl;
+    std::cout << "Usage: " << argv[0] << " <partial> [<partial> ...]";
+    std::cout << std::endl;
+    return (argc < 2) ? -1 : 0;
+  }
+  PartialResult total = ReadPartialResult(argv[1]);
+  std::vector<int> times_counted(total.header.num_blocks, 0);
+  for (int64_t b=0; b < total.header.num_blocks; b++)
+    times_counted[b] = total.done[b];
+  for (int i=2; i < argc; i++) {
+    PartialResult part = ReadPartialResult(argv[i]);
+    if (!SameProblem(total.header, part.header)) {
+      std::cout << argv[i] << " is for a different graph or clique size than ";
+      std::cout << argv[1] << std::endl;
+      std::exit(-9);
+    }
+    for (int64_t b=0; b < total.header.num_blocks; b++)
+      times_counted[b] += part.done[b];
+    for (int32_t c=0; c < total.header.num_counts; c++)
+      total.counts[c] += part.counts[c];
+  }
+
+  int64_t blocks_done = 0;
+  for (int64_t b=0; b < total.header.num_blocks; b++) {
+    if (times_counted[b] > 1) {
+      std::cout << "Root block " << b << " counted by multiple partial results";
+      std::cout << std::endl;
+      std::exit(-9);
+    }
+    blocks_done += times_counted[b];
+  }
+  PrintStep("Partial Results", static_cast<int64_t>(argc - 1));
+  PrintStep("Blocks Counted", blocks_done);
+  PrintStep("Total Blocks", total.header.num_blocks);
+  if (blocks_done != total.header.num_blocks)
+    std::cout << "WARNING: partial results do not cover all roots" << std::endl;
+
+  if (total.header.num_counts == 1) {
+    std::cout << "k: ";
+    PrintMergedRow(total.header.k, total.counts[0]);
+  } else {
+    printf("   k |                          clique count\n");
+    printf("--------------------------------------------\n");
+    for (int32_t k=0; k < total.header.num_counts; k++) {
+      if (total.counts[k] != 0)
+        PrintMergedRow(k, total.counts[k]);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,139 @@
+// Copyright (c) 2025, The Regents of the University of California (Regents)
+// See LICENSE for license details
+
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "clique_writer.h"
+#include "pivotscale.h"
+#include "sct.h"
+
+
+/*
+PivotScale
+File:   PivotScale-Query
+Author: Amogh Lonkar, Scott Beamer
+
+Answers clique counts from a succinct clique tree (from pivotscale-sct) by
+scanning its leaves, without the graph or any recounting
+- A leaf with h holds and p pivots has (p choose k-h) cliques of size k
+- Within a subset, a leaf only counts if all its holds are in the subset,
+  and then only its pivots in the subset can be chosen
+- Per vertex, every hold is in all of a leaf's k-cliques, and each pivot is
+  only in those that choose it, (p-1 choose k-h-1)
+*/
+
+
+std::vector<uint8_t> ReadSubset(const std::string &filename,
+                                int64_t num_nodes) {
+  std::ifstream file(filename);
+  if (!file) {
+    std::cout << "Couldn't open file " << filename << std::endl;
+    std::exit(-2);
+  }
+  std::vector<uint8_t> in_subset(num_nodes, false);
+  int64_t v;
+  while (file >> v) {
+    if ((v < 0) || (v >= num_nodes)) {
+      std::cout << "Vertex " << v << " is not in the graph" << std::endl;
+      std::exit(-9);
+    }
+    in_subset[v] = true;
+  }
+  return in_subset;
+}
+
+
+int main(int argc, char* argv[]) {
+  CLQuery cli(argc, argv, "PivotScale clique tree query");
+  if (!cli.ParseArgs()) {
+    return -1;
+  }
+  Timer t;
+  t.Start();
+  SCTReader reader(cli.sct_file());
+  const SCTFileHeader &header = reader.header();
+  std::vector<uint8_t> in_subset;
+  if (cli.subset_file() != "")
+    in_subset = ReadSubset(cli.subset_file(), header.num_nodes);
+  auto included = [&in_subset](NodeID v) {
+    return in_subset.empty() || in_subset[v];
+  };
+
+  NodeID k = cli.clique_size();
+  NodeID max_k = (k == 0) ? header.max_clique_size : k;
+  CombCache<count_t> n_choose_k;
+  std::vector<std::vector<count_t>> thread_counts(MaxThreads(),
+    std::vector<count_t>(max_k+1, 0));
+  std::vector<count_t> vertex_counts;
+  if (cli.vertex_counts_file() != "")
+    vertex_counts.resize(header.num_nodes, 0);
+
+  reader.ForEachLeaf([&](std::span<const NodeID> holds,
+                         std::span<const NodeID> pivots) {
+    NodeID num_holds = holds.size();
+    if (num_holds > max_k)
+      return;
+    for (NodeID u : holds) {
+      if (!included(u))
+        return;
+    }
+    NodeID num_pivots = 0;
+    for (NodeID u : pivots)
+      num_pivots += included(u);
+    std::vector<count_t> &counts = thread_counts[ThreadNum()];
+    if (k == 0) {
+      for (NodeID p=0; p <= std::min(num_pivots, max_k - num_holds); p++)
+        counts[num_holds + p] += n_choose_k(num_pivots, p);
+      return;
+    }
+    count_t hold_count = n_choose_k(num_pivots, k - num_holds);
+    counts[k] += hold_count;
+    if (vertex_counts.empty() || (hold_count == 0))
+      return;
+    for (NodeID u : holds) {
+      #pragma omp atomic
+      vertex_counts[u] += hold_count;
+    }
+    if (num_holds < k) {
+      count_t pivot_count = n_choose_k(num_pivots-1, k - num_holds - 1);
+      for (NodeID u : pivots) {
+        if (included(u)) {
+          #pragma omp atomic
+          vertex_counts[u] += pivot_count;
+        }
+      }
+    }
+  });
+
+  std::vector<count_t> counts(max_k+1, 0);
+  for (auto &local_counts : thread_counts) {
+    for (NodeID i=0; i <= max_k; i++)
+      counts[i] += local_counts[i];
+  }
+  if (!vertex_counts.empty()) {
+    std::ofstream out(cli.vertex_counts_file());
+    for (NodeID v=0; v < header.num_nodes; v++) {
+      if (vertex_counts[v] != 0)
+        out << v << " " << CountToString(vertex_counts[v]) << "\n";
+    }
+    if (!out) {
+      std::cout << "Couldn't write vertex counts to ";
+      std::cout << cli.vertex_counts_file() << std::endl;
+      std::exit(-6);
+    }
+  }
+  t.Stop();
+
+  PrintStep("Leaves", header.num_leaves);
+  PrintTime("Query Time", t.Seconds());
+  if (k != 0) {
+    std::cout << "k: ";
+    PrintCliqueCountRow(k, counts[k]);
+  } else {
+    PrintCliqueCounts(counts);
+  }
+  return 0;
+}
@@ -0,0 +1,271 @@
+// Copyright (c) 2025, The Regents of the University of California (Regents)
+// See LICENSE for license details
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pivot_count.h"
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif  // _OPENMP
+
+
+/*
+PivotScale
+File:   PivotScale-Server
+Author: Amogh Lonkar, Scott Beamer
+
+Loads and directionalizes a graph once, then answers clique counting
+requests over a unix domain socket
+- Connections are queued and served by a pool of worker threads, and each
+  worker counts with an even share of the OpenMP threads
+- Connections idle (while waiting for a request) for longer than the
+  timeout are closed, so silent clients can't hold workers forever
+- Each request is one line, and each response is terminated by an empty line
+    count <k>                    ->  count <k> <n>
+    sweep <k>                    ->  count <i> <n>  (for each nonzero i <= k)
+    subset <k> <v> [<v> ...]     ->  count <k> <n>  (cliques within vertices)
+    subset-sweep <k> <v> [...]   ->  count <i> <n>
+    stats                        ->  nodes, edges, and max_degree of the DAG
+    shutdown                     ->  stops the server once requests finish
+- Counting responses also include the counting time, and malformed requests
+  get an "error <reason>" response
+*/
+
+
+class ConnectionQueue {
+  std::deque<int> fds_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool closed_ = false;
+
+ public:
+  void Push(int fd) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      fds_.push_back(fd);
+    }
+    cv_.notify_one();
+  }
+
+  // Returns -1 once the queue has been closed and drained
+  int Pop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return closed_ || !fds_.empty(); });
+    if (fds_.empty())
+      return -1;
+    int fd = fds_.front();
+    fds_.pop_front();
+    return fd;
+  }
+
+  void Close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    cv_.notify_all();
+  }
+};
+
+
+class CountServer {
+  const Graph &dag_;
+  NodeID max_degree_;
+  int listen_fd_ = -1;
+  std::atomic<bool> shutting_down_{false};
+  ConnectionQueue queue_;
+
+  static std::string CountsResponse(const std::vector<count_t> &counts,
+                                    double seconds) {
+    std::ostringstream out;
+    for (size_t k=0; k < counts.size(); k++) {
+      if (counts[k] != 0)
+        out << "count " << k << " " << CountToString(counts[k]) << "\n";
+    }
+    out << "time " << seconds << "\n";
+    return out.str();
+  }
+
+  std::string HandleRequest(const std::string &line) {
+    std::istringstream in(line);
+    std::string command;
+    in >> command;
+    if (command == "stats") {
+      std::ostringstream out;
+      out << "nodes " << dag_.num_nodes() << "\n";
+      out << "edges " << dag_.num_edges_directed() << "\n";
+      out << "max_degree " << max_degree_ << "\n";
+      return out.str();
+    }
+    if (command == "shutdown") {
+      shutting_down_.store(true);
+      shutdown(listen_fd_, SHUT_RDWR);
+      return "shutting down\n";
+    }
+    bool sweep = (command == "sweep") || (command == "subset-sweep");
+    bool subset = (command == "subset") || (command == "subset-sweep");
+    if (!sweep && !subset && (command != "count"))
+      return "error unknown request " + command + "\n";
+    int64_t k;
+    if (!(in >> k) || (k < 1))
+      return "error missing or invalid clique size\n";
+    // cliques can have at most one more vertex than the max out-degree
+    NodeID max_k = std::min<int64_t>(k, max_degree_ + 1);
+    std::vector<NodeID> vertices;
+    PivotCountOptions<count_t> opts;
+    if (subset) {
+      int64_t v;
+      while (in >> v) {
+        if ((v < 0) || (v >= dag_.num_nodes()))
+          return "error vertex " + std::to_string(v) + " out of range\n";
+        vertices.push_back(v);
+      }
+      if (!in.eof())
+        return "error invalid vertex\n";
+      std::sort(vertices.begin(), vertices.end());
+      vertices.erase(std::unique(vertices.begin(), vertices.end()),
+                     vertices.end());
+      opts.subset = &vertices;
+    }
+    Timer t;
+    t.Start();
+    // sized by max_k, as k comes from the client (so could be huge)
+    std::vector<count_t> counts(max_k+1, 0);
+    if (sweep) {
+      std::vector<count_t> found = PivotCountSweep(dag_, max_k, opts);
+      std::copy(found.begin(), found.end(), counts.begin());
+    } else if (k == max_k) {
+      counts[k] = PivotCount(dag_, k, opts);
+    }
+    t.Stop();
+    if (!sweep) {
+      count_t count = (k == max_k) ? counts[k] : 0;
+      std::ostringstream out;
+      out << "count " << k << " " << CountToString(count) << "\n";
+      out << "time " << t.Seconds() << "\n";
+      return out.str();
+    }
+    return CountsResponse(counts, t.Seconds());
+  }
+
+  void Serve(int fd) {
+    std::string pending;
+    char buf[4096];
+    ssize_t num_read;
+    while ((num_read = read(fd, buf, sizeof(buf))) > 0) {
+      pending.append(buf, num_read);
+      size_t line_end;
+      while ((line_end = pending.find('\n')) != std::string::npos) {
+        std::string response = HandleRequest(pending.substr(0, line_end));
+        pending.erase(0, line_end + 1);
+        response += "\n";
+        if (write(fd, response.data(), response.size()) < 0)
+          return;
+      }
+    }
+  }
+
+  void Worker(int num_threads) {
+    #ifdef _OPENMP
+      omp_set_num_threads(num_threads);
+    #endif  // _OPENMP
+    int fd;
+    while ((fd = queue_.Pop()) != -1) {
+      Serve(fd);
+      close(fd);
+    }
+  }
+
+ public:
+  explicit CountServer(const Graph &dag) : dag_(dag) {
+    max_degree_ = Ordering::FindMaxDegree(dag);
+  }
+
+  void Run(const std::string &socket_path, int num_workers,
+           int idle_seconds) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+      std::cout << "Socket path too long: " << socket_path << std::endl;
+      std::exit(-6);
+    }
+    strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socket_path.c_str());
+    if ((listen_fd_ < 0) ||
+        (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+        || (listen(listen_fd_, SOMAXCONN) < 0)) {
+      std::cout << "Couldn't listen on " << socket_path << std::endl;
+      std::exit(-6);
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+    int threads_per_worker = 1;
+    #ifdef _OPENMP
+      threads_per_worker = std::max(omp_get_max_threads() / num_workers, 1);
+    #endif  // _OPENMP
+    std::vector<std::thread> workers;
+    for (int w=0; w < num_workers; w++)
+      workers.emplace_back(&CountServer::Worker, this, threads_per_worker);
+    std::cout << "Listening on " << socket_path << std::endl;
+    while (!shutting_down_.load()) {
+      int fd = accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0)
+        continue;
+      // reads in Serve then fail once idle too long, closing the connection
+      timeval timeout = {idle_seconds, 0};
+      setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+      queue_.Push(fd);
+    }
+    queue_.Close();
+    for (std::thread &worker : workers)
+      worker.join();
+    close(listen_fd_);
+    unlink(socket_path.c_str());
+  }
+};
+
+
+int main(int argc, char* argv[]) {
+  CLServer cli(argc, argv, "PivotScale clique counting server");
+  if (!cli.ParseArgs()) {
+    return -1;
+  }
+  Builder b(cli);
+  Timer t;
+  Graph dag;
+  {  // restricted scope to trigger deletion of g for memory savings
+    Graph g = b.MakeGraph();
+    if (g.directed()) {
+      std::cout << "Input graph is directed but clique counting requires";
+      std::cout << " undirected" << std::endl;
+      std::exit(-2);
+    }
+    t.Start();
+    dag = Ordering::Directionalize(g, b);
+    t.Stop();
+  }
+  dag.PrintStats();
+  PrintTime("Directing Time", t.Seconds());
+  std::cout << std::flush;
+
+  CountServer server(dag);
+  server.Run(cli.socket_path(), cli.num_workers(), cli.idle_seconds());
+  return 0;
+}
@@ -1,7 +1,7 @@
 // Copyright (c) 2025, The Regents of the University of California (Regents)
 // See LICENSE for license details
 
-#include "pivotscale.h"
+#include "pivot_count.h"
 
 
 /*
@@ -13,70 +13,9 @@ Counts occurrences of cliques for all sizes up to and including k
 */
 
 
-void PivotRecurse(SubGraph &sg, NodeID max_k, std::vector<count_t> &counts,
-                  NodeID clique_size, NodeID pivots) {
-  NodeID holds = clique_size - pivots;
-  if (sg.NumActive() == 0 || (holds == max_k)) {
-    for (NodeID p=0; p <= std::min(pivots, max_k - holds); p++) {
-      counts[holds + p] += n_choose_k(pivots, p);
-    }
-    return;
-  }
-  NodeID pivot_id_r = sg.FindPivot();
-  auto verts_to_induce = sg.ActiveUnreachableFromPivot(pivot_id_r);
-  for (NodeID v_r : verts_to_induce) {
-    if (v_r == pivot_id_r) {
-      std::vector<NodeID> empty_vec;
-      sg.InduceFromSelfMutate(v_r, empty_vec);
-      PivotRecurse(sg, max_k, counts, clique_size+1, pivots+1);
-    } else {
-      sg.InduceFromSelfMutate(v_r, verts_to_induce);
-      PivotRecurse(sg, max_k, counts, clique_size+1, pivots);
-    }
-    sg.UndoSelfMutate();
-  }
-  sg.PopNonNeighbors();
-}
-
-
-std::vector<count_t> PivotCount(const Graph &dag, NodeID max_k) {
-  std::vector<count_t> counts(max_k+1, 0);
-  #pragma omp parallel
-  {
-    SubGraph sg;
-    std::vector<count_t> local_counts(max_k+1, 0);
-    #pragma omp for schedule(dynamic, 1) nowait
-    for (NodeID v=0; v < dag.num_nodes(); v++) {
-      sg.InduceFromDAG(dag, v);
-      PivotRecurse(sg, max_k, local_counts, 1, 0);
-    }
-    for (size_t k=0; k < local_counts.size(); k++) {
-      #pragma omp atomic
-      counts[k] += local_counts[k];
-    }
-  }
-  return counts;
-}
-
-
-void PrintCliqueCounts(const std::vector<count_t> &counts) {
-  #ifdef USE_128
-    printf("   k |                          clique count\n");
-    printf("--------------------------------------------\n");
-  #else
-    printf("   k |        clique count\n");
-    printf("--------------------------\n");
-  #endif  // USE_128
-  for (size_t k=0; k < counts.size(); k++) {
-    if (counts[k] != 0) {
-      PrintCliqueCountRow(k, counts[k]);
-    }
-  }
-}
-
-
 int main(int argc, char* argv[]) {
-  CLKClique cli(argc, argv, "PivotScale clique count k-sweep", 3, false);
+  CLKClique cli(argc, argv, "PivotScale clique count k-sweep", 3, false,
+                true);
   if (!cli.ParseArgs()) {
     return -1;
   }
@@ -100,12 +39,59 @@ int main(int argc, char* argv[]) {
   PrintTime("Directing Time", direct_time);
 
   NodeID max_k = cli.max_k() ? Ordering::FindMaxDegree(dag)+1 : cli.clique_size();
+  std::unique_ptr<RootCheckpoint<count_t>> ckpt;
+  if (cli.checkpoint_file() != "") {
+    ckpt = std::make_unique<RootCheckpoint<count_t>>(cli.checkpoint_file(),
+             dag, max_k, max_k+1, cli.checkpoint_interval());
+    if (cli.num_shards() > 1) {
+      ckpt->RestrictToShard(dag, cli.shard(), cli.num_shards());
+      PrintStep("Shard Blocks", ckpt->NumShardBlocks());
+    }
+    if (cli.resume() && ckpt->Load())
+      PrintStep("Resumed Blocks", ckpt->NumResumedBlocks());
+  }
+
+  std::unique_ptr<ProgressMonitor> progress;
+  if (cli.progress_interval() >= 0) {
+    progress = std::make_unique<ProgressMonitor>(dag, cli.progress_interval());
+    progress->Start();
+  }
+
   t.Start();
-  std::vector<count_t> counts = PivotCount(dag, max_k);
+  PivotCountOptions<count_t> opts;
+  opts.ckpt = ckpt.get();
+  opts.progress = progress.get();
+  opts.split_root_cost = RelativeRootCost(dag, cli.split_factor());
+  opts.hub_min_degree = cli.hub_min_degree();
+  opts.hub_max_bytes = cli.hub_max_bytes();
+  opts.flat_rows = cli.flat_rows();
+  opts.complement_density = cli.complement_density();
+  CliqueMemoStats memo_stats;
+  opts.memo_max_verts = cli.memo_max_verts();
+  opts.memo_stats = &memo_stats;
+  int64_t twins_merged = 0;
+  opts.merge_twins = cli.merge_twins();
+  opts.twins_merged = &twins_merged;
+  opts.pivot_policy = PivotPolicyByName(cli.pivot_policy());
+  if (cli.compare_pivot_policies()) {
+    bool all_agree = ComparePivotPolicies(opts,
+      [&](const PivotCountOptions<count_t> &policy_opts) {
+        return PivotCountSweep(dag, max_k, policy_opts); },
+      [](const std::vector<count_t> &counts) {
+        PrintCliqueCounts(counts); });
+    return all_agree ? 0 : -1;
+  }
+  std::vector<count_t> counts = PivotCountSweep(dag, max_k, opts);
   t.Stop();
+  if (progress)
+    progress->Stop();
   double count_time = t.Seconds();
 
   PrintTime("Counting Time", count_time);
+  if (opts.merge_twins)
+    PrintStep("Merged Twins", twins_merged);
+  if (opts.memo_max_verts != 0)
+    memo_stats.Print();
   PrintTime("Total Time", direct_time + count_time);
   PrintCliqueCounts(counts);
   return 0;
@@ -1,7 +1,8 @@
 // Copyright (c) 2025, The Regents of the University of California (Regents)
 // See LICENSE for license details
 
-#include "pivotscale.h"
+#include "peel.h"
+#include "pivot_count.h"
 
 
 /*
@@ -10,52 +11,11 @@ File:   PivotScale
 Author: Amogh Lonkar, Scott Beamer
 
 Counts occurrences of cliques of size k
+- Optionally (-T) first peels the graph to the (k-1)-core and k-truss, as
+  only those vertices and edges can be in k-cliques
 */
 
 
-count_t PivotRecurse(SubGraph *sg, NodeID max_k, NodeID clique_size,
-                     NodeID num_pivots) {
-  if ((sg->NumActive() + clique_size) < max_k)
-    return 0;
-  NodeID num_holds = clique_size - num_pivots;
-  if (sg->NumActive() == 0 || (num_holds == max_k)) {
-    return n_choose_k(num_pivots, max_k - num_holds);
-  }
-  NodeID pivot_id_r = sg->FindPivot();
-  count_t count = 0;
-  auto verts_to_induce = sg->ActiveUnreachableFromPivot(pivot_id_r);
-  for (NodeID v_r : verts_to_induce) {
-    if (v_r == pivot_id_r) {
-      std::vector<NodeID> empty_vec;
-      sg->InduceFromSelfMutate(v_r, empty_vec);
-      count += PivotRecurse(sg, max_k, clique_size+1, num_pivots+1);
-    } else {
-      sg->InduceFromSelfMutate(v_r, verts_to_induce);
-      count += PivotRecurse(sg, max_k, clique_size+1, num_pivots);
-    }
-    sg->UndoSelfMutate();
-  }
-  sg->PopNonNeighbors();
-  return count;
-}
-
-
-count_t PivotCount(const Graph &dag, NodeID k) {
-  count_t count = 0;
-  #pragma omp parallel
-  {
-    SubGraph sg;
-    // SubGraph sg(dag.num_nodes()); // use only for dense
-    #pragma omp for reduction(+ : count) schedule(dynamic, 1)
-    for (NodeID v=0; v < dag.num_nodes(); v++) {
-      sg.InduceFromDAG(dag, v);
-      count += PivotRecurse(&sg, k, 1, 0);
-    }
-  }
-  return count;
-}
-
-
 int main(int argc, char* argv[]) {
   CLKClique cli(argc, argv, "PivotScale clique counting", 3, false);
   if (!cli.ParseArgs()) {
@@ -71,6 +31,19 @@ int main(int argc, char* argv[]) {
       std::cout << " undirected" << std::endl;
       std::exit(-2);
     }
+    if (cli.peel() && (cli.clique_size() >= 3)) {
+      t.Start();
+      g = Peel::ShrinkForCliques(g, cli.clique_size());
+      t.Stop();
+      PrintTime("Peel Time", t.Seconds());
+      PrintStep("Peeled Nodes", static_cast<int64_t>(g.num_nodes()));
+      PrintStep("Peeled Edges", g.num_edges());
+      if (g.num_edges() == 0) {
+        std::cout << "k: ";
+        PrintCliqueCountRow(cli.clique_size(), count_t(0));
+        return 0;
+      }
+    }
     t.Start();
     dag = Ordering::Directionalize(g, b);
     t.Stop();
@@ -81,12 +54,61 @@ int main(int argc, char* argv[]) {
   PrintStep("Max Degree", static_cast<int64_t>(Ordering::FindMaxDegree(dag)));
   PrintTime("Directing Time", direct_time);
 
+  std::unique_ptr<RootCheckpoint<count_t>> ckpt;
+  if (cli.checkpoint_file() != "") {
+    ckpt = std::make_unique<RootCheckpoint<count_t>>(cli.checkpoint_file(),
+             dag, cli.clique_size(), 1, cli.checkpoint_interval());
+    if (cli.num_shards() > 1) {
+      ckpt->RestrictToShard(dag, cli.shard(), cli.num_shards());
+      PrintStep("Shard Blocks", ckpt->NumShardBlocks());
+    }
+    if (cli.resume() && ckpt->Load())
+      PrintStep("Resumed Blocks", ckpt->NumResumedBlocks());
+  }
+
+  std::unique_ptr<ProgressMonitor> progress;
+  if (cli.progress_interval() >= 0) {
+    progress = std::make_unique<ProgressMonitor>(dag, cli.progress_interval());
+    progress->Start();
+  }
+
   t.Start();
-  count_t k_count = PivotCount(dag, cli.clique_size());
+  PivotCountOptions<count_t> opts;
+  opts.ckpt = ckpt.get();
+  opts.progress = progress.get();
+  opts.split_root_cost = RelativeRootCost(dag, cli.split_factor());
+  opts.hub_min_degree = cli.hub_min_degree();
+  opts.hub_max_bytes = cli.hub_max_bytes();
+  opts.flat_rows = cli.flat_rows();
+  opts.complement_density = cli.complement_density();
+  CliqueMemoStats memo_stats;
+  opts.memo_max_verts = cli.memo_max_verts();
+  opts.memo_stats = &memo_stats;
+  int64_t twins_merged = 0;
+  opts.merge_twins = cli.merge_twins();
+  opts.twins_merged = &twins_merged;
+  opts.color_min_active = cli.color_min_active();
+  opts.pivot_policy = PivotPolicyByName(cli.pivot_policy());
+  if (cli.compare_pivot_policies()) {
+    bool all_agree = ComparePivotPolicies(opts,
+      [&](const PivotCountOptions<count_t> &policy_opts) {
+        return PivotCount(dag, cli.clique_size(), policy_opts); },
+      [&](count_t k_count) {
+        std::cout << "k: ";
+        PrintCliqueCountRow(cli.clique_size(), k_count); });
+    return all_agree ? 0 : -1;
+  }
+  count_t k_count = PivotCount(dag, cli.clique_size(), opts);
   t.Stop();
+  if (progress)
+    progress->Stop();
   double count_time = t.Seconds();
 
   PrintTime("Counting Time", count_time);
+  if (opts.merge_twins)
+    PrintStep("Merged Twins", twins_merged);
+  if (opts.memo_max_verts != 0)
+    memo_stats.Print();
   PrintTime("Total Time", direct_time + count_time);
   std::cout << "k: ";
   PrintCliqueCountRow(cli.clique_size(), k_count);
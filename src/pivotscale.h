@@ -6,14 +6,19 @@
 
 #include <cstdint>
 #include <iostream>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "benchmark.h"
 #include "builder.h"
+#include "checkpoint.h"
 #include "comb_cache.h"
 #include "command_line.h"
 #include "graph.h"
 #include "ordering.h"
+#include "progress.h"
+#include "root_cost.h"
 #include "subgraph.h"
 
 
@@ -32,8 +37,6 @@ Header to share imports and utils between pivotscale.cc and pivotscale-sweep.cc
   using count_t = uint64_t;
 #endif  // USE_128
 
-CombCache<count_t> n_choose_k;
-
 void Print_uint128(unsigned __int128 x) {
   char buffer[40];
   int i = sizeof(buffer) - 1;
@@ -45,6 +48,15 @@ void Print_uint128(unsigned __int128 x) {
   printf("%39s", &buffer[i]);
 }
 
+std::string CountToString(unsigned __int128 x) {
+  std::string digits;
+  do {
+    digits.push_back('0' + (x % 10));
+    x /= 10;
+  } while (x > 0);
+  return std::string(digits.rbegin(), digits.rend());
+}
+
 void PrintCliqueCountRow(size_t k, count_t count) {
   #ifdef USE_128
     printf("%4zu ", k);
@@ -55,4 +67,20 @@ void PrintCliqueCountRow(size_t k, count_t count) {
   #endif  // USE_128
 }
 
+
+void PrintCliqueCounts(const std::vector<count_t> &counts) {
+  #ifdef USE_128
+    printf("   k |                          clique count\n");
+    printf("--------------------------------------------\n");
+  #else
+    printf("   k |        clique count\n");
+    printf("--------------------------\n");
+  #endif  // USE_128
+  for (size_t k=0; k < counts.size(); k++) {
+    if (counts[k] != 0) {
+      PrintCliqueCountRow(k, counts[k]);
+    }
+  }
+}
+
 #endif  // PIVOTSCALE_H_
@@ -0,0 +1,168 @@
+// Copyright (c) 2025, The Regents of the University of California (Regents)
+// See LICENSE for license details
+
+#ifndef PROGRESS_H_
+#define PROGRESS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <csignal>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+#include "graph.h"
+#include "platform_atomics.h"
+#include "root_cost.h"
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif  // _OPENMP
+
+
+/*
+PivotScale
+File:   Progress
+Author: Amogh Lonkar, Scott Beamer
+
+Reports progress and estimated time remaining while counting
+- Each counting thread registers a slot and only updates its own
+  (cache-line padded) counters, so recording a finished root is cheap
+- A monitor thread sums the slots and prints the percentage of estimated
+  root cost finished, throughput, and an ETA weighted by root cost
+- Prints every interval seconds (if positive) and whenever SIGUSR1 arrives
+- Roots skipped (e.g., resumed from checkpoint) count as finished, but are
+  excluded from throughput and ETA
+- Tree nodes are SubGraph inductions plus the children searched by the
+  bitmask kernels, but not nodes counted in closed form, by a CliqueMemo,
+  or in the complement (see PivotCount)
+*/
+
+
+class ProgressMonitor {
+ public:
+  struct alignas(64) Slot {
+    std::atomic<int64_t> roots{0};
+    std::atomic<int64_t> cost{0};
+    std::atomic<int64_t> tree_nodes{0};
+    std::atomic<int64_t> skipped_cost{0};
+
+    void Add(std::atomic<int64_t> &counter, int64_t inc) {
+      counter.fetch_add(inc, std::memory_order_relaxed);
+    }
+
+    void RootDone(int64_t root_cost, int64_t root_tree_nodes) {
+      Add(roots, 1);
+      Add(cost, root_cost);
+      Add(tree_nodes, root_tree_nodes);
+    }
+
+    // Records part of a root (e.g., one of its edge tasks), which finishes
+    // the root if it was the root's last part
+    void PartDone(int64_t part_cost, int64_t part_tree_nodes,
+                  bool root_finished) {
+      if (root_finished)
+        Add(roots, 1);
+      Add(cost, part_cost);
+      Add(tree_nodes, part_tree_nodes);
+    }
+
+    void RootSkipped(int64_t root_cost) {
+      Add(roots, 1);
+      Add(skipped_cost, root_cost);
+    }
+  };
+
+ private:
+  static const int kPollMillis = 100;
+  static inline volatile std::sig_atomic_t print_requested_ = 0;
+
+  std::vector<Slot> slots_;
+  int num_registered_ = 0;
+  int64_t num_roots_;
+  int64_t total_cost_;
+  double interval_secs_;
+  std::chrono::steady_clock::time_point start_time_;
+  std::atomic<bool> stop_{false};
+  std::thread monitor_;
+
+  static int NumSlots() {
+    #ifdef _OPENMP
+      return omp_get_max_threads();
+    #else
+      return 1;
+    #endif  // _OPENMP
+  }
+
+  static void HandleSignal(int) {
+    print_requested_ = 1;
+  }
+
+  double ElapsedSeconds() const {
+    return std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start_time_).count();
+  }
+
+  void Monitor() {
+    double next_print = interval_secs_;
+    while (!stop_.load()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(kPollMillis));
+      double elapsed = ElapsedSeconds();
+      bool interval_due = (interval_secs_ > 0) && (elapsed >= next_print);
+      if (interval_due || print_requested_) {
+        print_requested_ = 0;
+        PrintProgress(elapsed);
+        if (interval_due)
+          next_print = elapsed + interval_secs_;
+      }
+    }
+  }
+
+ public:
+  ProgressMonitor(const Graph &dag, double interval_secs) :
+      slots_(NumSlots()), num_roots_(dag.num_nodes()),
+      total_cost_(TotalRootCost(dag)), interval_secs_(interval_secs) {}
+
+  ~ProgressMonitor() {
+    Stop();
+  }
+
+  void Start() {
+    start_time_ = std::chrono::steady_clock::now();
+    std::signal(SIGUSR1, HandleSignal);
+    monitor_ = std::thread(&ProgressMonitor::Monitor, this);
+  }
+
+  void Stop() {
+    if (monitor_.joinable()) {
+      stop_.store(true);
+      monitor_.join();
+    }
+  }
+
+  // Called once by each counting thread to get its own counters
+  Slot* Register() {
+    return &slots_[fetch_and_add(num_registered_, 1) % slots_.size()];
+  }
+
+  void PrintProgress(double elapsed) const {
+    int64_t roots = 0, cost = 0, tree_nodes = 0, skipped_cost = 0;
+    for (const Slot &s : slots_) {
+      roots += s.roots.load(std::memory_order_relaxed);
+      cost += s.cost.load(std::memory_order_relaxed);
+      tree_nodes += s.tree_nodes.load(std::memory_order_relaxed);
+      skipped_cost += s.skipped_cost.load(std::memory_order_relaxed);
+    }
+    double frac_done = static_cast<double>(cost + skipped_cost) / total_cost_;
+    double cost_left = total_cost_ - cost - skipped_cost;
+    double eta = (cost > 0) ? elapsed * cost_left / cost : 0;
+    printf("Progress: %5.1lf%% roots %" PRId64 "/%" PRId64 "  nodes %" PRId64
+           " (%.3g/s)  elapsed %.1lfs  ETA %.1lfs\n", 100 * frac_done, roots,
+           num_roots_, tree_nodes, tree_nodes / elapsed, elapsed, eta);
+    fflush(stdout);
+  }
+};
+
+#endif  // PROGRESS_H_
@@ -0,0 +1,52 @@
+// Copyright (c) 2025, The Regents of the University of California (Regents)
+// See LICENSE for license details
+
+#ifndef ROOT_COST_H_
+#define ROOT_COST_H_
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "benchmark.h"
+#include "graph.h"
+
+
+/*
+PivotScale
+File:   RootCost
+Author: Amogh Lonkar, Scott Beamer
+
+Estimates the relative cost of counting from each root (DAG vertex)
+- Inducing a root's subgraph scans the out-neighbors of its out-neighbors
+- Recursing on the induced subgraph grows with the square of its size
+- Only meaningful relative to other roots (e.g., weighting progress)
+*/
+
+
+int64_t EstimateRootCost(const Graph &dag, NodeID v) {
+  int64_t degree = dag.out_degree(v);
+  int64_t induce_cost = 0;
+  for (NodeID w : dag.out_neigh(v))
+    induce_cost += dag.out_degree(w);
+  return 1 + induce_cost + degree * degree;
+}
+
+
+int64_t TotalRootCost(const Graph &dag) {
+  int64_t total = 0;
+  #pragma omp parallel for reduction(+ : total) schedule(dynamic, 1024)
+  for (NodeID v=0; v < dag.num_nodes(); v++)
+    total += EstimateRootCost(dag, v);
+  return total;
+}
+
+
+// Cost threshold for roots costing at least factor times the mean (0: none)
+int64_t RelativeRootCost(const Graph &dag, double factor) {
+  if ((factor <= 0) || (dag.num_nodes() == 0))
+    return 0;
+  double mean_cost = static_cast<double>(TotalRootCost(dag)) / dag.num_nodes();
+  return std::max(static_cast<int64_t>(factor * mean_cost), int64_t(1));
+}
+
+#endif  // ROOT_COST_H_
@@ -0,0 +1,258 @@
+// Copyright (c) 2025, The Regents of the University of California (Regents)
+// See LICENSE for license details
+
+#ifndef SCT_H_
+#define SCT_H_
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+
+
+/*
+PivotScale
+File:   SCT
+Author: Amogh Lonkar, Scott Beamer
+
+Saves and loads a succinct clique tree (SCT), the leaves of the complete
+pivot tree, each of which is a set of holds and a set of pivots
+- Every clique is the holds of exactly one leaf with some of its pivots, so
+  any count (any k, per vertex, or within a vertex subset) can be computed
+  by scanning the leaves without recounting
+- Leaves are written in independent blocks (one thread's buffer each), and
+  as consecutive leaves of a thread come from the same search, each leaf's
+  holds and pivots are stored as the length of the prefix shared with the
+  previous leaf in the block, then the rest of its vertices (as varints)
+- File is a header followed by blocks of (bytes, leaves, encoded leaves)
+*/
+
+
+struct SCTFileHeader {
+  static const uint64_t kMagic = 0x3130544353535650;  // "PVSSCT01"
+  uint64_t magic = kMagic;
+  int64_t num_nodes;
+  int64_t num_edges;
+  int64_t num_leaves = 0;
+  int32_t max_clique_size = 0;
+  int32_t reserved = 0;
+};
+
+
+struct SCTBlockHeader {
+  uint32_t num_bytes;
+  uint32_t num_leaves;
+};
+
+
+class SCTWriter {
+ public:
+  // Each thread adds leaves to its own buffer, written as a block when full
+  struct Buffer {
+    std::vector<uint8_t> bytes;
+    uint32_t num_leaves = 0;
+    int32_t max_clique_size = 0;
+    std::vector<NodeID> prev_holds;
+    std::vector<NodeID> prev_pivots;
+  };
+
+ private:
+  static const size_t kBlockBytes = 1 << 20;
+
+  FILE *file_;
+  SCTFileHeader header_;
+  std::mutex mutex_;
+  bool failed_ = false;
+
+  static void PutVarint(std::vector<uint8_t> &bytes, uint32_t x) {
+    while (x >= 0x80) {
+      bytes.push_back(static_cast<uint8_t>(x) | 0x80);
+      x >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(x));
+  }
+
+  static void PutSharedPrefix(std::vector<uint8_t> &bytes,
+                              std::vector<NodeID> &prev,
+                              std::span<const NodeID> verts) {
+    size_t shared = 0;
+    while ((shared < prev.size()) && (shared < verts.size()) &&
+           (prev[shared] == verts[shared]))
+      shared++;
+    PutVarint(bytes, shared);
+    PutVarint(bytes, verts.size() - shared);
+    for (size_t i=shared; i < verts.size(); i++)
+      PutVarint(bytes, verts[i]);
+    prev.assign(verts.begin(), verts.end());
+  }
+
+ public:
+  SCTWriter(const std::string &filename, int64_t num_nodes,
+            int64_t num_edges) {
+    file_ = fopen(filename.c_str(), "wb");
+    if (file_ == nullptr) {
+      std::cout << "Couldn't open file " << filename << std::endl;
+      std::exit(-6);
+    }
+    header_.num_nodes = num_nodes;
+    header_.num_edges = num_edges;
+    // rewritten with final totals by Close
+    failed_ |= fwrite(&header_, sizeof(header_), 1, file_) != 1;
+  }
+
+  ~SCTWriter() {
+    if (file_ != nullptr)
+      Close();
+  }
+
+  void AddLeaf(Buffer &buf, std::span<const NodeID> holds,
+               std::span<const NodeID> pivots) {
+    PutSharedPrefix(buf.bytes, buf.prev_holds, holds);
+    PutSharedPrefix(buf.bytes, buf.prev_pivots, pivots);
+    buf.num_leaves++;
+    buf.max_clique_size = std::max(buf.max_clique_size,
+      static_cast<int32_t>(holds.size() + pivots.size()));
+    if (buf.bytes.size() >= kBlockBytes)
+      WriteBlock(buf);
+  }
+
+  void WriteBlock(Buffer &buf) {
+    if (buf.num_leaves == 0)
+      return;
+    SCTBlockHeader block{static_cast<uint32_t>(buf.bytes.size()),
+                         buf.num_leaves};
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      failed_ |= fwrite(&block, sizeof(block), 1, file_) != 1;
+      failed_ |= fwrite(buf.bytes.data(), 1, buf.bytes.size(), file_) !=
+                 buf.bytes.size();
+      header_.num_leaves += buf.num_leaves;
+      header_.max_clique_size = std::max(header_.max_clique_size,
+                                         buf.max_clique_size);
+    }
+    // each block decodes on its own
+    buf.bytes.clear();
+    buf.num_leaves = 0;
+    buf.prev_holds.clear();
+    buf.prev_pivots.clear();
+  }
+
+  // Returns true if all blocks (and the final header) were written
+  bool Close() {
+    failed_ |= fseek(file_, 0, SEEK_SET) != 0;
+    failed_ |= fwrite(&header_, sizeof(header_), 1, file_) != 1;
+    failed_ |= fclose(file_) != 0;
+    file_ = nullptr;
+    return !failed_;
+  }
+
+  const SCTFileHeader& header() const {
+    return header_;
+  }
+};
+
+
+class SCTReader {
+  // blocks read at once, to be decoded in parallel
+  static const int kBatchBlocks = 64;
+
+  FILE *file_;
+  std::string filename_;
+  SCTFileHeader header_;
+
+  static uint32_t GetVarint(const uint8_t *&it) {
+    uint32_t x = 0;
+    for (int shift = 0; ; shift += 7) {
+      uint8_t byte = *(it++);
+      x |= static_cast<uint32_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0)
+        return x;
+    }
+  }
+
+  // verts holds the previous leaf's vertices, and is updated in place
+  static void GetSharedPrefix(const uint8_t *&it, std::vector<NodeID> &verts) {
+    uint32_t shared = GetVarint(it);
+    verts.resize(shared + GetVarint(it));
+    for (size_t i=shared; i < verts.size(); i++)
+      verts[i] = GetVarint(it);
+  }
+
+  void Truncated() {
+    std::cout << filename_ << " is truncated" << std::endl;
+    std::exit(-9);
+  }
+
+ public:
+  explicit SCTReader(const std::string &filename) : filename_(filename) {
+    file_ = fopen(filename.c_str(), "rb");
+    if (file_ == nullptr) {
+      std::cout << "Couldn't open file " << filename << std::endl;
+      std::exit(-2);
+    }
+    if ((fread(&header_, sizeof(header_), 1, file_) != 1) ||
+        (header_.magic != SCTFileHeader::kMagic)) {
+      std::cout << filename << " is not a clique tree file" << std::endl;
+      std::exit(-9);
+    }
+  }
+
+  ~SCTReader() {
+    fclose(file_);
+  }
+
+  const SCTFileHeader& header() const {
+    return header_;
+  }
+
+  // Calls leaf(holds, pivots) concurrently from all threads for each leaf
+  template <typename LeafF_>
+  void ForEachLeaf(LeafF_ leaf) {
+    fseek(file_, sizeof(header_), SEEK_SET);
+    std::vector<std::vector<uint8_t>> blocks(kBatchBlocks);
+    std::vector<uint32_t> block_leaves(kBatchBlocks);
+    int64_t leaves_seen = 0;
+    while (true) {
+      int num_blocks = 0;
+      SCTBlockHeader block;
+      while ((num_blocks < kBatchBlocks) &&
+             (fread(&block, sizeof(block), 1, file_) == 1)) {
+        blocks[num_blocks].resize(block.num_bytes);
+        if (fread(blocks[num_blocks].data(), 1, block.num_bytes, file_) !=
+            block.num_bytes)
+          Truncated();
+        block_leaves[num_blocks] = block.num_leaves;
+        leaves_seen += block.num_leaves;
+        num_blocks++;
+      }
+      if (num_blocks == 0)
+        break;
+      #pragma omp parallel
+      {
+        std::vector<NodeID> holds, pivots;
+        #pragma omp for schedule(dynamic, 1)
+        for (int b=0; b < num_blocks; b++) {
+          const uint8_t *it = blocks[b].data();
+          holds.clear();
+          pivots.clear();
+          for (uint32_t l=0; l < block_leaves[b]; l++) {
+            GetSharedPrefix(it, holds);
+            GetSharedPrefix(it, pivots);
+            leaf(std::span<const NodeID>(holds),
+                 std::span<const NodeID>(pivots));
+          }
+        }
+      }
+    }
+    if (leaves_seen != header_.num_leaves)
+      Truncated();
+  }
+};
+
+#endif  // SCT_H_
@@ -0,0 +1,273 @@
+// Copyright (c) 2025, The Regents of the University of California (Regents)
+// See LICENSE for license details
+
+#ifndef SIMD_FILTER_H_
+#define SIMD_FILTER_H_
+
+#include <array>
+#include <bit>
+#include <cinttypes>
+#include <cstdlib>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_FILTER_X86
+#endif
+
+#include "benchmark.h"
+
+
+/*
+PivotScale
+File:   SimdFilter
+Author: Amogh Lonkar, Scott Beamer
+
+Filters a list of local IDs by a bitset, used by SubGraph to compact its
+rows and to take set differences with its active set
+- FilterByBits splits a list into the IDs whose bit is set (to out_set) and
+  the rest (to out_unset, if given), each kept in its original order
+- Checks 16 IDs at a time with AVX-512 (gather of bitset words, then
+  compress), or 8 at a time with AVX2 (gather, then a permute from a
+  shuffle table), with the rest of the list handled by the scalar loop
+- Widest level supported by the CPU is picked at runtime, which can be
+  lowered for comparison with PIVOTSCALE_SIMD=avx2 or PIVOTSCALE_SIMD=scalar
+- Outputs need room for all n IDs, since each vector is stored whole, and
+  out_set may be the input list itself (writes never pass reads)
+*/
+
+
+namespace SimdFilter {
+
+enum Level { kScalar, kAVX2, kAVX512 };
+
+
+Level DetectLevel() {
+  Level level = kScalar;
+#ifdef SIMD_FILTER_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    level = kAVX2;
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+      && __builtin_cpu_supports("avx512vl"))
+    level = kAVX512;
+#endif
+  if (const char *requested = std::getenv("PIVOTSCALE_SIMD")) {
+    std::string name(requested);
+    if (name == "scalar")
+      level = kScalar;
+    else if ((name == "avx2") && (level > kAVX2))
+      level = kAVX2;
+  }
+  return level;
+}
+
+
+Level ActiveLevel() {
+  static const Level level = DetectLevel();
+  return level;
+}
+
+
+template <typename LocalID_>
+bool IsSet(const uint64_t *bits, LocalID_ id) {
+  return (bits[id >> 6] >> (id & 63)) & 1;
+}
+
+
+// Reference version, also finishes the vector versions' lists
+template <typename LocalID_>
+NodeID FilterScalar(const LocalID_ *in, NodeID n, const uint64_t *bits,
+                    LocalID_ *out_set, LocalID_ *out_unset,
+                    NodeID num_set = 0, NodeID num_unset = 0,
+                    NodeID start = 0) {
+  for (NodeID i=start; i < n; i++) {
+    LocalID_ id = in[i];
+    if (IsSet(bits, id))
+      out_set[num_set++] = id;
+    else if (out_unset != nullptr)
+      out_unset[num_unset++] = id;
+  }
+  return num_set;
+}
+
+
+#ifdef SIMD_FILTER_X86
+
+#define SIMD_FILTER_AVX512 __attribute__((target("avx512f,avx512bw,avx512vl")))
+#define SIMD_FILTER_AVX2 __attribute__((target("avx2")))
+
+// maskz forms (with all lanes) avoid gcc warnings about undefined sources
+const __mmask16 kAllLanes = 0xffff;
+
+// Loads 16 IDs (of any width) into 32-bit lanes
+SIMD_FILTER_AVX512 __m512i Load16(const uint8_t *p) {
+  return _mm512_maskz_cvtepu8_epi32(kAllLanes,
+                                    _mm_loadu_si128((const __m128i*) p));
+}
+
+SIMD_FILTER_AVX512 __m512i Load16(const uint16_t *p) {
+  return _mm512_maskz_cvtepu16_epi32(kAllLanes,
+      _mm256_loadu_si256((const __m256i*) p));
+}
+
+SIMD_FILTER_AVX512 __m512i Load16(const int32_t *p) {
+  return _mm512_loadu_si512(p);
+}
+
+
+// Stores the first num_ids lanes (narrowed to the ID width)
+SIMD_FILTER_AVX512 void Store16(uint8_t *p, __mmask16 m, __m512i ids) {
+  _mm512_mask_cvtepi32_storeu_epi8(p, m, ids);
+}
+
+SIMD_FILTER_AVX512 void Store16(uint16_t *p, __mmask16 m, __m512i ids) {
+  _mm512_mask_cvtepi32_storeu_epi16(p, m, ids);
+}
+
+SIMD_FILTER_AVX512 void Store16(int32_t *p, __mmask16 m, __m512i ids) {
+  _mm512_mask_storeu_epi32(p, m, ids);
+}
+
+
+template <typename LocalID_>
+SIMD_FILTER_AVX512
+NodeID FilterAVX512(const LocalID_ *in, NodeID n, const uint64_t *bits,
+                    LocalID_ *out_set, LocalID_ *out_unset) {
+  const __m512i low_five = _mm512_set1_epi32(31);
+  const __m512i one = _mm512_set1_epi32(1);
+  NodeID num_set = 0, num_unset = 0;
+  NodeID i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512i ids = Load16(in + i);
+    // bit id of bitset is bit (id & 31) of its (id >> 5)th 32-bit word
+    __m512i words = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(),
+      kAllLanes, _mm512_maskz_srli_epi32(kAllLanes, ids, 5), bits, 4);
+    __m512i shifted = _mm512_maskz_srlv_epi32(kAllLanes, words,
+                                              _mm512_and_si512(ids, low_five));
+    __mmask16 set = _mm512_test_epi32_mask(shifted, one);
+    int count = std::popcount(static_cast<unsigned>(set));
+    Store16(out_set + num_set, static_cast<__mmask16>((1u << count) - 1),
+            _mm512_maskz_compress_epi32(set, ids));
+    num_set += count;
+    if (out_unset != nullptr) {
+      Store16(out_unset + num_unset,
+              static_cast<__mmask16>((1u << (16 - count)) - 1),
+              _mm512_maskz_compress_epi32(~set, ids));
+      num_unset += 16 - count;
+    }
+  }
+  return FilterScalar(in, n, bits, out_set, out_unset, num_set, num_unset, i);
+}
+
+
+// Entry m holds the lanes (a byte each) of the set bits of m, in order
+constexpr std::array<uint64_t, 256> MakeShuffleTable() {
+  std::array<uint64_t, 256> table{};
+  for (int m=0; m < 256; m++) {
+    int count = 0;
+    for (int lane=0; lane < 8; lane++) {
+      if (m & (1 << lane))
+        table[m] |= static_cast<uint64_t>(lane) << (8 * count++);
+    }
+  }
+  return table;
+}
+
+constexpr std::array<uint64_t, 256> kShuffleTable = MakeShuffleTable();
+
+
+SIMD_FILTER_AVX2 __m256i Load8(const uint8_t *p) {
+  return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) p));
+}
+
+SIMD_FILTER_AVX2 __m256i Load8(const uint16_t *p) {
+  return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*) p));
+}
+
+SIMD_FILTER_AVX2 __m256i Load8(const int32_t *p) {
+  return _mm256_loadu_si256((const __m256i*) p);
+}
+
+
+// Moves lanes of m to the front and stores all 8 lanes (narrowed to the ID
+// width), as lanes past the count are overwritten by later stores
+SIMD_FILTER_AVX2 __m256i Compress8(int m, __m256i ids) {
+  __m256i perm = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(kShuffleTable[m]));
+  return _mm256_permutevar8x32_epi32(ids, perm);
+}
+
+SIMD_FILTER_AVX2 void Store8(uint8_t *p, int m, __m256i ids) {
+  __m256i zero = _mm256_setzero_si256();
+  __m256i words = _mm256_packus_epi32(Compress8(m, ids), zero);
+  __m256i bytes = _mm256_packus_epi16(words, zero);
+  // each 128-bit half now starts with 4 of the bytes
+  bytes = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 0, 0, 0,
+                                                               0, 0, 0));
+  _mm_storel_epi64((__m128i*) p, _mm256_castsi256_si128(bytes));
+}
+
+SIMD_FILTER_AVX2 void Store8(uint16_t *p, int m, __m256i ids) {
+  __m256i zero = _mm256_setzero_si256();
+  __m256i words = _mm256_packus_epi32(Compress8(m, ids), zero);
+  // each 128-bit half now starts with 4 of the words
+  words = _mm256_permute4x64_epi64(words, 0x8);
+  _mm_storeu_si128((__m128i*) p, _mm256_castsi256_si128(words));
+}
+
+SIMD_FILTER_AVX2 void Store8(int32_t *p, int m, __m256i ids) {
+  _mm256_storeu_si256((__m256i*) p, Compress8(m, ids));
+}
+
+
+template <typename LocalID_>
+SIMD_FILTER_AVX2
+NodeID FilterAVX2(const LocalID_ *in, NodeID n, const uint64_t *bits,
+                  LocalID_ *out_set, LocalID_ *out_unset) {
+  const __m256i low_five = _mm256_set1_epi32(31);
+  const __m256i one = _mm256_set1_epi32(1);
+  NodeID num_set = 0, num_unset = 0;
+  NodeID i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i ids = Load8(in + i);
+    __m256i words = _mm256_i32gather_epi32(
+      reinterpret_cast<const int*>(bits), _mm256_srli_epi32(ids, 5), 4);
+    __m256i shifted = _mm256_srlv_epi32(words, _mm256_and_si256(ids,
+                                                                low_five));
+    __m256i is_set = _mm256_cmpeq_epi32(_mm256_and_si256(shifted, one), one);
+    int set = _mm256_movemask_ps(_mm256_castsi256_ps(is_set));
+    int count = std::popcount(static_cast<unsigned>(set));
+    Store8(out_set + num_set, set, ids);
+    num_set += count;
+    if (out_unset != nullptr) {
+      Store8(out_unset + num_unset, set ^ 0xff, ids);
+      num_unset += 8 - count;
+    }
+  }
+  return FilterScalar(in, n, bits, out_set, out_unset, num_set, num_unset, i);
+}
+
+#endif  // SIMD_FILTER_X86
+
+
+// Returns the number of IDs in in[0, n) whose bit is set, which are written
+// to out_set, with the rest written to out_unset (if not nullptr)
+template <typename LocalID_>
+NodeID FilterByBits(const LocalID_ *in, NodeID n, const uint64_t *bits,
+                    LocalID_ *out_set, LocalID_ *out_unset) {
+#ifdef SIMD_FILTER_X86
+  switch (ActiveLevel()) {
+    case kAVX512:
+      return FilterAVX512(in, n, bits, out_set, out_unset);
+    case kAVX2:
+      return FilterAVX2(in, n, bits, out_set, out_unset);
+    default:
+      break;
+  }
+#endif
+  return FilterScalar(in, n, bits, out_set, out_unset);
+}
+
+}  // namespace SimdFilter
+
+#endif  // SIMD_FILTER_H_
@@ -4,8 +4,13 @@
 #ifndef SUBGRAPH_H_
 #define SUBGRAPH_H_
 
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <span>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -13,6 +18,7 @@
 #include "graph.h"
 #include "grouped_stack.h"
 #include "hash_table8.hpp"
+#include "simd_filter.h"
 
 
 /*
@@ -25,49 +31,389 @@ Subgraph providing capabilities needed for Pivotscale
 - Further subgraph inductions mutate this data structure (InduceFromSelfMutate)
 - Can undo a subgraph induction (UndoSelfMutate)
 - Can induce (and undo) an arbitrary number of times (uses stack internally)
+- Can also track an excluded (X) set for enumerating maximal cliques
+  (InduceFromDAGWithExcluded and the WithExcluded variants)
+- Once the active set is much smaller than the rows (sized for the root),
+  can copy it into a compact child subgraph (ShrinkToChild), so deeper
+  levels scan small arrays, and dropping the child is the undo
+  (PIVOTSCALE_SHRINK_FACTOR and PIVOTSCALE_SHRINK_MIN lower when this
+  happens, so small test graphs also exercise it)
+- Once the active set fits in a machine word, can convert it to adjacency
+  bitmasks (ActiveMasks) for the bitmask kernels of PivotCount
+- Can convert a dense active set to bitset rows of its complement
+  (ActiveComplementRows) for counting independent sets there instead
+- Tracks the number of active edges (NumActiveEdges), so callers can
+  recognize complete or edgeless active sets in constant time
+- Picks pivots by a selectable rule (see PivotPolicy), exact by default
+- Can build the rows of an induction from the DAG flat (SetFlatRows), in
+  one CSR array from a single scan of the DAG, and then compact them in
+  place there, so no row needs its own list or is ever copied
+- Compacts rows and finds non-neighbors of the pivot with vector filters
+  where the CPU supports them (see SimdFilter), or otherwise scalar loops
+- Templated by the type of local IDs, which only need to fit the number of
+  vertices induced (e.g., a root's out-degree), so narrower IDs for smaller
+  subgraphs reduce memory traffic (see SubGraphByWidth)
 */
 
 
+// Rules for picking the pivot of an active set (see SubGraph::FindPivot),
+// which only change the shape of the pivot tree, never the cliques found
+enum class PivotPolicy {
+  // highest active degree (fewest branches)
+  kMaxDegree,
+  // highest active degree within an evenly strided sample of a large
+  // active set (cheaper to find, but may branch more)
+  kSampled,
+  // highest active degree among the non-neighbors of the previous pivot
+  // that are still active (or among all active vertices if none are)
+  kPrevNonNeighs,
+  // fewest active non-neighbors (so also highest active degree), with ties
+  // going to the highest core rank, approximated by the out-degree in the
+  // DAG induced from (the degree when peeled for the core ordering)
+  kMinNonNeighs
+};
+
+const int kNumPivotPolicies = 4;
+// short names (e.g., for command line flags) in PivotPolicy order
+const char* const kPivotPolicyNames[kNumPivotPolicies] = {
+  "max", "sample", "prev", "min"};
+
+// Value of environment variable name (at least least), or default_value if
+// unset, for overriding tuning thresholds when testing
+NodeID EnvThreshold(const char *name, NodeID default_value, NodeID least) {
+  if (const char *requested = std::getenv(name))
+    return std::max(least, static_cast<NodeID>(std::atol(requested)));
+  return default_value;
+}
+
+
+// Policy with the given short name (or kMaxDegree if none)
+PivotPolicy PivotPolicyByName(const std::string &name) {
+  for (int p=0; p < kNumPivotPolicies; p++) {
+    if (name == kPivotPolicyNames[p])
+      return static_cast<PivotPolicy>(p);
+  }
+  return PivotPolicy::kMaxDegree;
+}
+
+
+template <typename LocalID_ = NodeID>
 class SubGraph {
-  // active list (P set)
-  std::vector<uint8_t> active_;
-  std::vector<NodeID> active_list_;
+  // active set (P set) as bitset, and list of its vertices
+  std::vector<uint64_t> active_;
+  std::vector<LocalID_> active_list_;
   // adjacency list
-  std::vector<std::vector<NodeID>> adj_list_;
-  std::vector<NodeID> active_tails_;
+  std::vector<std::vector<LocalID_>> adj_list_;
+  std::vector<LocalID_> active_tails_;
+  // original (graph) ID of each local vertex
+  std::vector<NodeID> orig_ids_;
   // stack-style frames to hold dropped vertices or non-neighbors of pivot
-  GroupedStack<NodeID> dropped_verts_;
-  GroupedStack<NodeID> pivot_non_neighs_;
+  GroupedStack<LocalID_> dropped_verts_;
+  GroupedStack<LocalID_> pivot_non_neighs_;
+  // undo log of (vertex, old active tail) for tails shortened by each frame
+  GroupedStack<std::pair<LocalID_, LocalID_>> tail_log_;
+  // sum of active degrees, and its value before each frame
+  int64_t active_degree_sum_ = 0;
+  std::vector<int64_t> degree_sum_log_;
+  // number of inductions performed (nodes in pivot tree), for instrumentation
+  int64_t num_inductions_ = 0;
+  // excluded list (X set for maximal cliques), with frames of X vertices
+  // dropped or added by each induction, and temporary neighbor marks
+  std::vector<uint8_t> excluded_;
+  std::vector<LocalID_> excluded_list_;
+  GroupedStack<LocalID_> dropped_excluded_;
+  GroupedStack<LocalID_> added_excluded_;
+  std::vector<uint8_t> neigh_marks_;
+  // greedy coloring of active vertices (all 0 between colorings)
+  std::vector<NodeID> color_of_;
+  std::vector<uint8_t> color_used_;
+  std::vector<NodeID> color_starts_;
+  // compact copy of active part (reused by each shrink), and map from local
+  // IDs of this subgraph to the child's or mask bits (all -1 between uses)
+  std::unique_ptr<SubGraph> child_;
+  std::vector<LocalID_> compact_ids_;
+  // output space for vector filters (sized for the rows)
+  std::vector<LocalID_> filter_scratch_;
+  // if flat_rows_, InduceFromDAG stages each row (out-neighbors then
+  // in-neighbors, CSR style), and while rows_staged_ rows live there
+  bool flat_rows_ = false;
+  bool rows_staged_ = false;
+  std::vector<NodeID> staged_starts_;
+  std::vector<LocalID_> staged_neighs_;
+  std::vector<NodeID> out_starts_;
+  std::vector<LocalID_> staged_outs_;
+  // rule for FindPivot, and DAG induced from (if any) for its tie ranks
+  PivotPolicy pivot_policy_ = PivotPolicy::kMaxDegree;
+  const Graph *induced_dag_ = nullptr;
+  // kSampled only samples active sets at least this large
+  static const NodeID kMinSampledActive = 1024;
+  static const NodeID kPivotSamples = 64;
+  bool use_simd_ = SimdFilter::ActiveLevel() != SimdFilter::kScalar;
+  // shrink once active set is at most 1/shrink_factor_ of the rows (factor
+  // at least 2, so each child has at most half the rows of its parent)
+  static inline const NodeID shrink_factor_ =
+      EnvThreshold("PIVOTSCALE_SHRINK_FACTOR", 8, 2);
+  static inline const NodeID min_shrink_active_ =
+      EnvThreshold("PIVOTSCALE_SHRINK_MIN", 64, 1);
+
+  bool IsActive(NodeID v_r) const {
+    return (active_[v_r >> 6] >> (v_r & 63)) & 1;
+  }
+
+  void MarkActive(NodeID v_r) {
+    active_[v_r >> 6] |= uint64_t(1) << (v_r & 63);
+  }
+
+  void UnmarkActive(NodeID v_r) {
+    active_[v_r >> 6] &= ~(uint64_t(1) << (v_r & 63));
+  }
+
+  // Sizes all per-vertex arrays for num_rows local vertices (none active)
+  void ResetRows(NodeID num_rows) {
+    active_.assign((num_rows + 63) / 64, 0);
+    active_list_.clear();
+    adj_list_.resize(num_rows);
+    active_tails_.resize(num_rows);
+    orig_ids_.resize(num_rows);
+    dropped_verts_.clear();
+    tail_log_.clear();
+    pivot_non_neighs_.clear();
+    pivot_non_neighs_.reserve(num_rows);
+    excluded_list_.clear();
+    filter_scratch_.resize(num_rows);
+    active_degree_sum_ = 0;
+    degree_sum_log_.clear();
+    rows_staged_ = false;
+    induced_dag_ = nullptr;
+  }
+
+  // Row of v_r (active neighbors before its tail), staged or its own list
+  LocalID_* Row(NodeID v_r) {
+    return rows_staged_ ? staged_neighs_.data() + staged_starts_[v_r]
+                        : adj_list_[v_r].data();
+  }
+
+  // Scans the out-neighbors of the active vertices (keeping those in
+  // remapper) once to set their degrees and stage their rows
+  void StageRows(const Graph &dag,
+                 const emhash8::HashMap<NodeID, NodeID> &remapper) {
+    NodeID num_rows = active_list_.size();
+    out_starts_.assign(num_rows + 1, 0);
+    staged_outs_.clear();
+    for (NodeID v_r=0; v_r < num_rows; v_r++)
+      active_tails_[v_r] = 0;
+    for (NodeID v_r=0; v_r < num_rows; v_r++) {
+      for (NodeID w : dag.out_neigh(orig_ids_[v_r])) {
+        auto it = remapper.find(w);
+        if (it != remapper.end()) {
+          staged_outs_.push_back(it->second);
+          active_tails_[v_r]++;
+          active_tails_[it->second]++;
+        }
+      }
+      out_starts_[v_r+1] = staged_outs_.size();
+    }
+    // staged_starts_[v_r+1] starts as the start of row v_r and serves as its
+    // fill position, so it ends as the end of row v_r (start of the next)
+    staged_starts_.assign(num_rows + 1, 0);
+    for (NodeID v_r=1; v_r < num_rows; v_r++) {
+      staged_starts_[v_r+1] = staged_starts_[v_r] + active_tails_[v_r-1];
+    }
+    staged_neighs_.resize(int64_t(staged_outs_.size()) * 2);
+    for (NodeID v_r=0; v_r < num_rows; v_r++) {
+      NodeID out_degree = out_starts_[v_r+1] - out_starts_[v_r];
+      std::copy_n(staged_outs_.begin() + out_starts_[v_r], out_degree,
+                  staged_neighs_.begin() + staged_starts_[v_r+1]);
+      staged_starts_[v_r+1] += out_degree;
+    }
+    for (NodeID v_r=0; v_r < num_rows; v_r++) {
+      for (NodeID j=out_starts_[v_r]; j < out_starts_[v_r+1]; j++)
+        staged_neighs_[staged_starts_[staged_outs_[j] + 1]++] = v_r;
+    }
+    rows_staged_ = true;
+  }
+
+  void SumActiveDegrees() {
+    active_degree_sum_ = 0;
+    for (NodeID n_r : active_list_)
+      active_degree_sum_ += active_tails_[n_r];
+  }
+
+  // Swaps now inactive neighbors of n_r past its active tail (logging the
+  // old tail if it shrinks)
+  void CompactNeighs(NodeID n_r) {
+    NodeID old_tail = active_tails_[n_r];
+    LocalID_ *row = Row(n_r);
+    if (use_simd_) {
+      // stable partition of the active part of the row (by active bits)
+      NodeID new_tail = SimdFilter::FilterByBits(row, old_tail, active_.data(),
+                                                 row, filter_scratch_.data());
+      if (new_tail != old_tail) {
+        std::copy_n(filter_scratch_.data(), old_tail - new_tail,
+                    row + new_tail);
+        active_tails_[n_r] = new_tail;
+        tail_log_.push_back(std::pair<LocalID_, LocalID_>(n_r, old_tail));
+      }
+      return;
+    }
+    for (NodeID j=0; j < active_tails_[n_r]; j++) {
+      NodeID v_r = row[j];
+      if (!IsActive(v_r)) {
+        // v_r is now inactive, so need to swap to back of neighbor list
+        NodeID new_tail = active_tails_[n_r] - 1;
+        NodeID tail_v_r = row[new_tail];
+        while ((new_tail > j) && (!IsActive(tail_v_r))) {
+          new_tail--;
+          tail_v_r = row[new_tail];
+        }
+        if (new_tail > j) {
+          std::swap(row[j], row[new_tail]);
+        }
+        active_tails_[n_r] = new_tail;
+      }
+    }
+    if (active_tails_[n_r] != old_tail)
+      tail_log_.push_back(std::pair<LocalID_, LocalID_>(n_r, old_tail));
+  }
+
+  // Assigns each active vertex the lowest color (from 1) not used by its
+  // already colored neighbors, and returns the number of colors used
+  NodeID GreedyColorActive() {
+    color_of_.resize(orig_ids_.size(), 0);
+    color_used_.resize(NumActive() + 2, false);
+    NodeID num_colors = 0;
+    for (NodeID v_r : active_list_) {
+      for (NodeID w_r : Neighs(v_r))
+        color_used_[color_of_[w_r]] = true;
+      NodeID c = 1;
+      while (color_used_[c])
+        c++;
+      for (NodeID w_r : Neighs(v_r))
+        color_used_[color_of_[w_r]] = false;
+      color_of_[v_r] = c;
+      num_colors = std::max(num_colors, c);
+    }
+    return num_colors;
+  }
+
+  NodeID FindMaxDegreePivot() const {
+    assert(NumActive() > 0);
+    NodeID max_v_r = active_list_.front();
+    for (NodeID n_r : active_list_) {
+      if (active_tails_[n_r] > active_tails_[max_v_r])
+        max_v_r = n_r;
+    }
+    return max_v_r;
+  }
+
+  NodeID FindSampledPivot() const {
+    NodeID num_active = NumActive();
+    if (num_active < kMinSampledActive)
+      return FindMaxDegreePivot();
+    NodeID stride = num_active / kPivotSamples;
+    NodeID max_v_r = active_list_.front();
+    for (NodeID i=0; i < num_active; i += stride) {
+      NodeID n_r = active_list_[i];
+      if (active_tails_[n_r] > active_tails_[max_v_r])
+        max_v_r = n_r;
+    }
+    return max_v_r;
+  }
+
+  // Previous pivot's non-neighbors are the last frame of pivot_non_neighs_
+  NodeID FindPrevNonNeighPivot() const {
+    NodeID max_v_r = -1;
+    if (!pivot_non_neighs_.empty()) {
+      for (NodeID n_r : pivot_non_neighs_.last_frame_iter()) {
+        if (IsActive(n_r) &&
+            ((max_v_r == -1) || (active_tails_[n_r] > active_tails_[max_v_r])))
+          max_v_r = n_r;
+      }
+    }
+    return (max_v_r == -1) ? FindMaxDegreePivot() : max_v_r;
+  }
+
+  // Active non-neighbors of n_r (including itself) number NumActive() minus
+  // its active degree, so minimizing them maximizes degree
+  NodeID FindMinNonNeighPivot() const {
+    if (induced_dag_ == nullptr)
+      return FindMaxDegreePivot();
+    NodeID max_v_r = active_list_.front();
+    for (NodeID n_r : active_list_) {
+      if ((active_tails_[n_r] > active_tails_[max_v_r]) ||
+          ((active_tails_[n_r] == active_tails_[max_v_r]) &&
+           (induced_dag_->out_degree(orig_ids_[n_r]) >
+            induced_dag_->out_degree(orig_ids_[max_v_r]))))
+        max_v_r = n_r;
+    }
+    return max_v_r;
+  }
 
+  // Removes vertices no longer marked active (from active_) from active list
+  // (saving them in a new frame of dropped_verts_) and compacts the rest
+  // (logging their tails in a new frame of tail_log_)
+  void DropInactive() {
+    dropped_verts_.create_new_frame();
+    tail_log_.create_new_frame();
+    degree_sum_log_.push_back(active_degree_sum_);
+    active_degree_sum_ = 0;
+    // count on active_list_ to hold old active_ to recognize future inactive
+    for (NodeID i=0; i < static_cast<NodeID>(active_list_.size()); i++) {
+      NodeID n_r = active_list_[i];
+      if (IsActive(n_r)) {
+        CompactNeighs(n_r);
+        active_degree_sum_ += active_tails_[n_r];
+      } else {
+        // n_r is now inactive, so remove from active and add to dropped
+        std::swap(active_list_[i], active_list_.back());
+        active_list_.pop_back();
+        dropped_verts_.push_back(n_r);
+        i--;
+      }
+    }
+  }
 
  public:
   SubGraph() {}
 
 
   void InduceFromDAG(const Graph &dag, NodeID u) {
+    InduceFromDAG(dag, u, [](NodeID) { return true; });
+  }
+
+
+  // Only includes out-neighbors v of u for which include(v) is true
+  template <typename IncludeF_>
+  void InduceFromDAG(const Graph &dag, NodeID u, IncludeF_ include) {
     // Initialize and reset data structures
     NodeID num_orig_nodes = dag.out_degree(u);
     emhash8::HashMap<NodeID, NodeID> remapper;
     remapper.reserve(num_orig_nodes);
-    active_.assign(num_orig_nodes, false);
-    active_list_.clear();
-    adj_list_.resize(num_orig_nodes);
-    active_tails_.resize(num_orig_nodes);
-    dropped_verts_.clear();
-    pivot_non_neighs_.clear();
-    pivot_non_neighs_.reserve(num_orig_nodes);
+    ResetRows(num_orig_nodes);
+    induced_dag_ = &dag;
+    num_inductions_++;
 
     // Populate remappings for vertices included and mark active
     for (NodeID v : dag.out_neigh(u)) {
+      if (!include(v))
+        continue;
       NodeID v_r = remapper.size();
       remapper.emplace_unique(v, v_r);
-      active_[v_r] = true;
+      orig_ids_[v_r] = v;
+      MarkActive(v_r);
       active_list_.push_back(v_r);
       adj_list_[v_r].clear();
     }
+    if (flat_rows_) {
+      StageRows(dag, remapper);
+      SumActiveDegrees();
+      return;
+    }
 
     // Build new subgraph of neighbors of u
     for (NodeID v : dag.out_neigh(u)) {
+      if (!include(v))
+        continue;
       NodeID v_r = remapper[v];
       for (NodeID w : dag.out_neigh(v)) {
         if (remapper.contains(w)) {
@@ -80,115 +426,471 @@ class SubGraph {
     for (NodeID v_r : active_list_) {
       active_tails_[v_r] = adj_list_[v_r].size();
     }
+    SumActiveDegrees();
+  }
+
+
+  // Induces from an explicit vertex set of an undirected graph, where
+  // neighs(v) returns all neighbors of v, and only edges (v, w) for which
+  // keep_edge(v, w) is true are included
+  template <typename NeighF_, typename KeepEdgeF_>
+  void InduceFromSet(std::span<const NodeID> verts, NeighF_ neighs,
+                     KeepEdgeF_ keep_edge) {
+    NodeID num_orig_nodes = verts.size();
+    emhash8::HashMap<NodeID, NodeID> remapper;
+    remapper.reserve(num_orig_nodes);
+    ResetRows(num_orig_nodes);
+    num_inductions_++;
+
+    for (NodeID v : verts) {
+      NodeID v_r = remapper.size();
+      remapper.emplace_unique(v, v_r);
+      orig_ids_[v_r] = v;
+      MarkActive(v_r);
+      active_list_.push_back(v_r);
+      adj_list_[v_r].clear();
+    }
+
+    // each undirected edge is seen from both sides, so only add it from lower
+    for (NodeID v : verts) {
+      NodeID v_r = remapper[v];
+      for (NodeID w : neighs(v)) {
+        if ((v < w) && remapper.contains(w) && keep_edge(v, w)) {
+          NodeID w_r = remapper[w];
+          adj_list_[v_r].push_back(w_r);
+          adj_list_[w_r].push_back(v_r);
+        }
+      }
+    }
+    for (NodeID v_r : active_list_) {
+      active_tails_[v_r] = adj_list_[v_r].size();
+    }
+    SumActiveDegrees();
+  }
+
+
+  // Also fills the excluded (X) set with the neighbors of u in g that are not
+  // out-neighbors in dag (they precede u), for enumerating maximal cliques
+  void InduceFromDAGWithExcluded(const Graph &g, const Graph &dag, NodeID u) {
+    NodeID num_orig_nodes = g.out_degree(u);
+    emhash8::HashMap<NodeID, NodeID> remapper;
+    remapper.reserve(num_orig_nodes);
+    ResetRows(num_orig_nodes);
+    induced_dag_ = &dag;
+    excluded_.assign(num_orig_nodes, false);
+    neigh_marks_.assign(num_orig_nodes, false);
+    dropped_excluded_.clear();
+    added_excluded_.clear();
+    num_inductions_++;
+
+    for (NodeID v : dag.out_neigh(u)) {
+      NodeID v_r = remapper.size();
+      remapper.emplace_unique(v, v_r);
+      orig_ids_[v_r] = v;
+      MarkActive(v_r);
+      active_list_.push_back(v_r);
+      adj_list_[v_r].clear();
+    }
+    for (NodeID v : g.out_neigh(u)) {
+      if (remapper.contains(v))
+        continue;
+      NodeID v_r = remapper.size();
+      remapper.emplace_unique(v, v_r);
+      orig_ids_[v_r] = v;
+      excluded_[v_r] = true;
+      excluded_list_.push_back(v_r);
+      adj_list_[v_r].clear();
+    }
+
+    // active neighbors go before excluded ones (beyond active tail)
+    for (NodeID v_r : active_list_) {
+      for (NodeID w : dag.out_neigh(orig_ids_[v_r])) {
+        if (remapper.contains(w)) {
+          NodeID w_r = remapper[w];
+          adj_list_[v_r].push_back(w_r);
+          adj_list_[w_r].push_back(v_r);
+        }
+      }
+    }
+    for (NodeID v_r : active_list_) {
+      active_tails_[v_r] = adj_list_[v_r].size();
+    }
+    // excluded vertices precede u, so they also precede all active vertices
+    for (NodeID x_r : excluded_list_) {
+      for (NodeID w : dag.out_neigh(orig_ids_[x_r])) {
+        auto it = remapper.find(w);
+        if ((it != remapper.end()) && IsActive(it->second)) {
+          adj_list_[x_r].push_back(it->second);
+          adj_list_[it->second].push_back(x_r);
+        }
+      }
+    }
+    for (NodeID x_r : excluded_list_) {
+      active_tails_[x_r] = adj_list_[x_r].size();
+    }
+    SumActiveDegrees();
+  }
+
+
+  // Whether later inductions from the DAG build rows flat (see StageRows)
+  void SetFlatRows(bool flat) {
+    flat_rows_ = flat;
   }
 
 
-  NodeID NumActive() {
+  NodeID NumActive() const {
     return active_list_.size();
   }
 
 
-  std::span<const NodeID> Neighs(NodeID u_r) const {
-    return std::span(&adj_list_[u_r][0], &adj_list_[u_r][active_tails_[u_r]]);
+  int64_t NumActiveEdges() const {
+    return active_degree_sum_ / 2;
   }
 
 
-  // has highest active degree (or tied)
-  NodeID FindPivot() {
-    assert(NumActive() > 0);
-    NodeID max_v_r = active_list_.front();
+  NodeID MinActiveDegree() const {
+    NodeID min_degree = NumActive();
     for (NodeID n_r : active_list_) {
-      if (active_tails_[n_r] > active_tails_[max_v_r])
-        max_v_r = n_r;
+      NodeID degree = active_tails_[n_r];
+      min_degree = std::min(min_degree, degree);
+    }
+    return min_degree;
+  }
+
+
+  NodeID MaxActiveDegree() const {
+    NodeID max_degree = 0;
+    for (NodeID n_r : active_list_) {
+      NodeID degree = active_tails_[n_r];
+      max_degree = std::max(max_degree, degree);
+    }
+    return max_degree;
+  }
+
+
+  NodeID NumExcluded() const {
+    return excluded_list_.size();
+  }
+
+
+  NodeID OrigID(NodeID u_r) const {
+    return orig_ids_[u_r];
+  }
+
+
+  std::span<const LocalID_> Neighs(NodeID u_r) {
+    LocalID_ *row = Row(u_r);
+    return std::span(row, row + active_tails_[u_r]);
+  }
+
+
+  // Rule used by FindPivot (for this subgraph and its children)
+  void SetPivotPolicy(PivotPolicy policy) {
+    pivot_policy_ = policy;
+  }
+
+
+  // Picks an active vertex by the pivot policy (by default, one with the
+  // highest active degree)
+  NodeID FindPivot() {
+    switch (pivot_policy_) {
+      case PivotPolicy::kSampled:       return FindSampledPivot();
+      case PivotPolicy::kPrevNonNeighs: return FindPrevNonNeighPivot();
+      case PivotPolicy::kMinNonNeighs:  return FindMinNonNeighPivot();
+      default:                          return FindMaxDegreePivot();
+    }
+  }
+
+
+  // has highest active degree among active and excluded (or tied)
+  NodeID FindPivotWithExcluded() {
+    NodeID max_v_r = FindMaxDegreePivot();
+    for (NodeID x_r : excluded_list_) {
+      if (active_tails_[x_r] > active_tails_[max_v_r])
+        max_v_r = x_r;
     }
     return max_v_r;
   }
 
 
+  // Greedily colors active vertices (in active list order) and returns the
+  // number of colors (an upper bound on the size of a clique among them),
+  // with order holding active vertices sorted by color, and colors[i] the
+  // color (starting from 1) of order[i]
+  NodeID ColorActive(std::vector<NodeID> &order, std::vector<NodeID> &colors) {
+    NodeID num_active = NumActive();
+    NodeID num_colors = GreedyColorActive();
+    // counting sort by color
+    color_starts_.assign(num_colors + 2, 0);
+    for (NodeID v_r : active_list_)
+      color_starts_[color_of_[v_r] + 1]++;
+    for (NodeID c=1; c <= num_colors; c++)
+      color_starts_[c+1] += color_starts_[c];
+    order.resize(num_active);
+    colors.resize(num_active);
+    for (NodeID v_r : active_list_) {
+      NodeID pos = color_starts_[color_of_[v_r]]++;
+      order[pos] = v_r;
+      colors[pos] = color_of_[v_r];
+      color_of_[v_r] = 0;
+    }
+    return num_colors;
+  }
+
+
+  // Only returns number of colors of greedy coloring (see ColorActive)
+  NodeID NumColorsActive() {
+    NodeID num_colors = GreedyColorActive();
+    for (NodeID v_r : active_list_)
+      color_of_[v_r] = 0;
+    return num_colors;
+  }
+
+
   // NOTE: includes self (usually pivot) since no self-loops
-  std::span<const NodeID> ActiveUnreachableFromPivot(NodeID u_r) {
+  // The frame is read by index, as deeper levels can push more frames (than
+  // were reserved) while the caller still loops over it
+  typename GroupedStack<LocalID_>::Frame ActiveUnreachableFromPivot(
+      NodeID u_r) {
     pivot_non_neighs_.create_new_frame();
     // mark all neighbors as inactive
     for (NodeID v_r : Neighs(u_r)) {
-      active_[v_r] = false;
+      UnmarkActive(v_r);
     }
     // recognize difference between active and active_list to do set difference
-    for (NodeID n_r : active_list_) {
-      if (active_[n_r]) {
-        pivot_non_neighs_.push_back(n_r);
-      } else {
-        active_[n_r] = true;
+    if (use_simd_) {
+      NodeID num_non_neighs = SimdFilter::FilterByBits(active_list_.data(),
+          NumActive(), active_.data(), filter_scratch_.data(),
+          static_cast<LocalID_*>(nullptr));
+      pivot_non_neighs_.append(std::span<const LocalID_>(
+        filter_scratch_.data(), num_non_neighs));
+      for (NodeID v_r : Neighs(u_r)) {
+        MarkActive(v_r);
+      }
+    } else {
+      for (NodeID n_r : active_list_) {
+        if (IsActive(n_r)) {
+          pivot_non_neighs_.push_back(n_r);
+        } else {
+          MarkActive(n_r);
+        }
       }
     }
-    return pivot_non_neighs_.last_frame_iter();
+    return pivot_non_neighs_.last_frame();
   }
 
 
-  void InduceFromSelfMutate(NodeID u_r, const std::span<const NodeID> &excl) {
+  void InduceFromSelfMutate(NodeID u_r,
+                            const std::span<const LocalID_> &excl) {
+    num_inductions_++;
     // unset all bitmap entries (temporary)
     for (NodeID n_r : active_list_) {
-      active_[n_r] = false;
+      UnmarkActive(n_r);
     }
     // set bitmap for next active
     for (NodeID v_r : Neighs(u_r)) {
-      active_[v_r] = true;
+      MarkActive(v_r);
     }
     // subtract excl(usion) list from active, considering vertex ID ordering
     for (NodeID n_r : excl) {
       if (n_r < u_r)
-        active_[n_r] = false;
+        UnmarkActive(n_r);
     }
-    dropped_verts_.create_new_frame();
-    // count on active_list_ to hold old active_ to recognize future inactive
-    for (NodeID i=0; i < static_cast<NodeID>(active_list_.size()); i++) {
-      NodeID n_r = active_list_[i];
-      if (active_[n_r]) {
-        for (NodeID j=0; j < active_tails_[n_r]; j++) {
-          NodeID v_r = adj_list_[n_r][j];
-          if (!active_[v_r]) {
-            // v_r is now inactive, so need to swap to back of neighbor list
-            NodeID new_tail = active_tails_[n_r] - 1;
-            NodeID tail_v_r = adj_list_[n_r][new_tail];
-            while ((new_tail > j) && (!active_[tail_v_r])) {
-              new_tail--;
-              tail_v_r = adj_list_[n_r][new_tail];
-            }
-            if (new_tail > j) {
-              std::swap(adj_list_[n_r][j], adj_list_[n_r][new_tail]);
-            }
-            active_tails_[n_r] = new_tail;
-          }
-        }
-      } else {
-        // n_r is now inactive, so remove from active and add to dropped
-        std::swap(active_list_[i], active_list_.back());
-        active_list_.pop_back();
-        dropped_verts_.push_back(n_r);
-        i--;
-      }
+    DropInactive();
+  }
+
+
+  // Like InduceFromSelfMutate, but drops all of removed (regardless of IDs)
+  void InduceFromSelfMutateWithout(NodeID u_r,
+                                   const std::span<const LocalID_> &removed) {
+    num_inductions_++;
+    for (NodeID n_r : active_list_) {
+      UnmarkActive(n_r);
     }
+    for (NodeID v_r : Neighs(u_r)) {
+      MarkActive(v_r);
+    }
+    for (NodeID n_r : removed) {
+      UnmarkActive(n_r);
+    }
+    DropInactive();
   }
 
 
   void UndoSelfMutate() {
     // mark last dropped vertices as active
     for (NodeID n_r : dropped_verts_.last_frame_iter()) {
-      active_[n_r] = true;
+      MarkActive(n_r);
       active_list_.push_back(n_r);
     }
     dropped_verts_.pop_frame();
-    // for all active vertices, extend neighbor lists to include newly active
-    for (NodeID u_r : active_list_) {
-      NodeID new_tail = active_tails_[u_r];
-      while (new_tail < static_cast<NodeID>(adj_list_[u_r].size())) {
-        NodeID tail_v_r = adj_list_[u_r][new_tail];
-        if (active_[tail_v_r])
-          new_tail++;
-        else
-          break;
+    // restore only the tails the induction shortened, which again cover
+    // exactly the neighbors active before it (rows are only permuted)
+    for (auto [n_r, old_tail] : tail_log_.last_frame_iter())
+      active_tails_[n_r] = old_tail;
+    tail_log_.pop_frame();
+    active_degree_sum_ = degree_sum_log_.back();
+    degree_sum_log_.pop_back();
+  }
+
+
+  // Like InduceFromSelfMutate, but vertices in excl (with lower IDs) that
+  // neighbor u_r join the excluded set instead of being dropped, and the
+  // excluded set is also restricted to neighbors of u_r
+  void InduceFromSelfMutateWithExcluded(NodeID u_r,
+                                        const std::span<const LocalID_> &excl) {
+    num_inductions_++;
+    // all rows are complete (beyond active tail), so marks all neighbors
+    for (NodeID v_r : adj_list_[u_r]) {
+      neigh_marks_[v_r] = true;
+    }
+    for (NodeID n_r : active_list_) {
+      if (!neigh_marks_[n_r])
+        UnmarkActive(n_r);
+    }
+    dropped_excluded_.create_new_frame();
+    for (NodeID i=0; i < static_cast<NodeID>(excluded_list_.size()); i++) {
+      NodeID x_r = excluded_list_[i];
+      if (!neigh_marks_[x_r]) {
+        excluded_[x_r] = false;
+        std::swap(excluded_list_[i], excluded_list_.back());
+        excluded_list_.pop_back();
+        dropped_excluded_.push_back(x_r);
+        i--;
+      }
+    }
+    added_excluded_.create_new_frame();
+    for (NodeID n_r : excl) {
+      if ((n_r < u_r) && IsActive(n_r)) {
+        UnmarkActive(n_r);
+        excluded_[n_r] = true;
+        excluded_list_.push_back(n_r);
+        added_excluded_.push_back(n_r);
       }
-      active_tails_[u_r] = new_tail;
     }
+    for (NodeID v_r : adj_list_[u_r]) {
+      neigh_marks_[v_r] = false;
+    }
+    DropInactive();
+    for (NodeID x_r : excluded_list_) {
+      CompactNeighs(x_r);
+    }
+  }
+
+
+  void UndoSelfMutateWithExcluded() {
+    // deeper inductions may have reordered excluded list, so filter it
+    for (NodeID n_r : added_excluded_.last_frame_iter()) {
+      excluded_[n_r] = false;
+    }
+    added_excluded_.pop_frame();
+    std::erase_if(excluded_list_, [this](LocalID_ x_r) {
+      return !excluded_[x_r]; });
+    for (NodeID x_r : dropped_excluded_.last_frame_iter()) {
+      excluded_[x_r] = true;
+      excluded_list_.push_back(x_r);
+    }
+    dropped_excluded_.pop_frame();
+    // also restores tails of excluded rows (logged in the same frame)
+    UndoSelfMutate();
+  }
+
+
+  // Counts pivot tree nodes searched outside of this subgraph (e.g., by the
+  // bitmask kernels of PivotCount) as inductions
+  void AddInductions(int64_t num_nodes) {
+    num_inductions_ += num_nodes;
+  }
+
+
+  // Includes inductions by children
+  int64_t NumInductions() const {
+    return num_inductions_ + (child_ ? child_->NumInductions() : 0);
+  }
+
+
+  // If the active set has shrunk enough, copies it (with the active
+  // neighbors of each) into the child with renumbered local IDs and returns
+  // it (to recurse on instead), or otherwise returns nullptr
+  SubGraph* ShrinkToChild() {
+    NodeID num_active = NumActive();
+    if ((num_active < min_shrink_active_) ||
+        (num_active * shrink_factor_ > static_cast<NodeID>(orig_ids_.size())))
+      return nullptr;
+    if (!child_)
+      child_ = std::make_unique<SubGraph>();
+    compact_ids_.resize(orig_ids_.size(), -1);
+    SubGraph &child = *child_;
+    child.ResetRows(num_active);
+    child.pivot_policy_ = pivot_policy_;
+    child.induced_dag_ = induced_dag_;
+    for (NodeID i=0; i < num_active; i++) {
+      compact_ids_[active_list_[i]] = i;
+      child.MarkActive(i);
+      child.active_list_.push_back(i);
+      child.orig_ids_[i] = orig_ids_[active_list_[i]];
+    }
+    for (NodeID i=0; i < num_active; i++) {
+      std::vector<LocalID_> &row = child.adj_list_[i];
+      row.clear();
+      for (NodeID w_r : Neighs(active_list_[i]))
+        row.push_back(compact_ids_[w_r]);
+      child.active_tails_[i] = row.size();
+    }
+    child.active_degree_sum_ = active_degree_sum_;
+    for (NodeID n_r : active_list_)
+      compact_ids_[n_r] = -1;
+    return child_.get();
+  }
+
+
+  // For an active set of at most kMaxMaskVerts, sets masks[i] to the active
+  // neighbors of the vertex at active_list_[i] (as bits in the same order)
+  static const NodeID kMaxMaskVerts = 64;
+  void ActiveMasks(uint64_t *masks) {
+    assert(NumActive() <= kMaxMaskVerts);
+    compact_ids_.resize(orig_ids_.size(), -1);
+    for (NodeID i=0; i < NumActive(); i++)
+      compact_ids_[active_list_[i]] = i;
+    for (NodeID i=0; i < NumActive(); i++) {
+      uint64_t mask = 0;
+      for (NodeID w_r : Neighs(active_list_[i]))
+        mask |= uint64_t(1) << compact_ids_[w_r];
+      masks[i] = mask;
+    }
+    for (NodeID n_r : active_list_)
+      compact_ids_[n_r] = -1;
+  }
+
+
+  // Sets rows (num_words per vertex) to the active non-neighbors (excluding
+  // self) of each active vertex, as bits in active list order, where
+  // num_words covers NumActive() bits
+  void ActiveComplementRows(std::vector<uint64_t> &rows, NodeID num_words) {
+    NodeID num_active = NumActive();
+    compact_ids_.resize(orig_ids_.size(), -1);
+    for (NodeID i=0; i < num_active; i++)
+      compact_ids_[active_list_[i]] = i;
+    rows.assign(int64_t(num_active) * num_words, 0);
+    for (NodeID i=0; i < num_active; i++) {
+      uint64_t *row = &rows[int64_t(i) * num_words];
+      for (NodeID j=0; j < num_active; j++)
+        row[j >> 6] |= uint64_t(1) << (j & 63);
+      row[i >> 6] &= ~(uint64_t(1) << (i & 63));
+      for (NodeID w_r : Neighs(active_list_[i])) {
+        NodeID j = compact_ids_[w_r];
+        row[j >> 6] &= ~(uint64_t(1) << (j & 63));
+      }
+    }
+    for (NodeID n_r : active_list_)
+      compact_ids_[n_r] = -1;
+  }
+
+
+  // Whether local IDs of this width can index num_verts vertices (and hold
+  // an active tail of num_verts)
+  static bool Fits(NodeID num_verts) {
+    return num_verts <= std::numeric_limits<LocalID_>::max();
   }
 
 
@@ -209,7 +911,7 @@ class SubGraph {
   }
 
 
-  void PrintTopology() const {
+  void PrintTopology() {
     for (NodeID u_r : active_list_) {
       std::cout << u_r << ": ";
       for (NodeID v_r : Neighs(u_r)) {
@@ -230,4 +932,41 @@ class SubGraph {
   }
 };
 
+
+// One SubGraph of each local ID width (each reused across roots), so each
+// root is searched with the narrowest local IDs that fit its out-degree
+class SubGraphByWidth {
+  SubGraph<uint8_t> narrow_;
+  SubGraph<uint16_t> medium_;
+  SubGraph<NodeID> wide_;
+
+ public:
+  // Returns f(sg) for the narrowest sg that fits num_verts vertices
+  template <typename F_>
+  auto Use(NodeID num_verts, F_ f) {
+    if (SubGraph<uint8_t>::Fits(num_verts))
+      return f(narrow_);
+    if (SubGraph<uint16_t>::Fits(num_verts))
+      return f(medium_);
+    return f(wide_);
+  }
+
+  int64_t NumInductions() const {
+    return narrow_.NumInductions() + medium_.NumInductions() +
+           wide_.NumInductions();
+  }
+
+  void SetFlatRows(bool flat) {
+    narrow_.SetFlatRows(flat);
+    medium_.SetFlatRows(flat);
+    wide_.SetFlatRows(flat);
+  }
+
+  void SetPivotPolicy(PivotPolicy policy) {
+    narrow_.SetPivotPolicy(policy);
+    medium_.SetPivotPolicy(policy);
+    wide_.SetPivotPolicy(policy);
+  }
+};
+
 #endif  // SUBGRAPH_H_
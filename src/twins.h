@@ -0,0 +1,141 @@
+// Copyright (c) 2025, The Regents of the University of California (Regents)
+// See LICENSE for license details
+
+#ifndef TWINS_H_
+#define TWINS_H_
+
+#include <algorithm>
+#include <cinttypes>
+#include <utility>
+#include <vector>
+
+#include "benchmark.h"
+#include "graph.h"
+
+
+/*
+PivotScale
+File:   RootTwins
+Author: Amogh Lonkar, Scott Beamer
+
+Groups roots (DAG vertices) with identical out-neighbor lists (twins), whose
+induced subgraphs and thus clique counts are the same, so counting can
+search one representative per group and reuse its counts for the rest
+- Hashes each (sorted) out-neighbor list, sorts roots by hash, and confirms
+  twins by comparing lists, so hash collisions never merge roots
+- Roots are identified by position (e.g., i for PivotCountOptions::Root(i)),
+  and only those for which eligible(i) is true are grouped (e.g., not
+  already checkpointed or split into edge tasks)
+- The first position of each group is its representative, and the rest are
+  merged into it (to be skipped)
+- Hashes with num_threads OpenMP threads
+*/
+
+
+class RootTwins {
+  static const NodeID kSingle = -1;
+  static const NodeID kMerged = -2;
+  // group of each representative (or kSingle or kMerged), and positions in
+  // each group (CSR style)
+  std::vector<NodeID> group_of_;
+  std::vector<NodeID> group_starts_;
+  std::vector<NodeID> members_;
+  NodeID num_merged_ = 0;
+
+  static uint64_t HashNeighs(const Graph &dag, NodeID u) {
+    uint64_t h = dag.out_degree(u);
+    for (NodeID v : dag.out_neigh(u)) {
+      h ^= static_cast<uint64_t>(v) + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2);
+      h *= 0xbf58476d1ce4e5b9;
+    }
+    return h;
+  }
+
+  static bool SameNeighs(const Graph &dag, NodeID u, NodeID w) {
+    auto u_neighs = dag.out_neigh(u);
+    auto w_neighs = dag.out_neigh(w);
+    return std::equal(u_neighs.begin(), u_neighs.end(),
+                      w_neighs.begin(), w_neighs.end());
+  }
+
+ public:
+  RootTwins() {}
+
+  template <typename RootF_, typename EligibleF_>
+  RootTwins(const Graph &dag, NodeID num_roots, RootF_ root,
+            EligibleF_ eligible, int num_threads) :
+      group_of_(num_roots, kSingle) {
+    std::vector<std::pair<uint64_t, NodeID>> keyed(num_roots);
+    #pragma omp parallel for schedule(dynamic, 1024) num_threads(num_threads)
+    for (NodeID i=0; i < num_roots; i++) {
+      NodeID u = root(i);
+      if ((dag.out_degree(u) > 0) && eligible(i))
+        keyed[i] = std::make_pair(HashNeighs(dag, u), i);
+      else
+        keyed[i] = std::make_pair(0, -1);
+    }
+    std::erase_if(keyed, [](const auto &p) { return p.second == -1; });
+    std::sort(keyed.begin(), keyed.end());
+    group_starts_.push_back(0);
+    for (size_t start=0; start < keyed.size(); ) {
+      size_t end = start + 1;
+      while ((end < keyed.size()) && (keyed[end].first == keyed[start].first))
+        end++;
+      // within a run of equal hashes, each unclaimed root starts a group
+      for (size_t r=start; r < end; r++) {
+        NodeID rep = keyed[r].second;
+        if (group_of_[rep] != kSingle)
+          continue;
+        size_t group_start = members_.size();
+        members_.push_back(rep);
+        for (size_t t=r+1; t < end; t++) {
+          NodeID twin = keyed[t].second;
+          if ((group_of_[twin] == kSingle) &&
+              SameNeighs(dag, root(rep), root(twin))) {
+            group_of_[twin] = kMerged;
+            members_.push_back(twin);
+          }
+        }
+        if (members_.size() - group_start == 1) {
+          members_.pop_back();
+          continue;
+        }
+        num_merged_ += members_.size() - group_start - 1;
+        group_of_[rep] = group_starts_.size() - 1;
+        group_starts_.push_back(members_.size());
+      }
+      start = end;
+    }
+  }
+
+  // Whether i is counted by (and reported with) its representative
+  bool IsMerged(NodeID i) const {
+    return !group_of_.empty() && (group_of_[i] == kMerged);
+  }
+
+  // Number of roots (including i) sharing the counts of representative i
+  NodeID NumTwins(NodeID i) const {
+    if (group_of_.empty() || (group_of_[i] < 0))
+      return 1;
+    NodeID g = group_of_[i];
+    return group_starts_[g+1] - group_starts_[g];
+  }
+
+  // Calls f(j) for each position j (including i) of the group of i
+  template <typename F_>
+  void ForEachTwin(NodeID i, F_ f) const {
+    if (group_of_.empty() || (group_of_[i] < 0)) {
+      f(i);
+      return;
+    }
+    NodeID g = group_of_[i];
+    for (NodeID m=group_starts_[g]; m < group_starts_[g+1]; m++)
+      f(members_[m]);
+  }
+
+  NodeID NumMerged() const {
+    return num_merged_;
+  }
+};
+
+#endif  // TWINS_H_